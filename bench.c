@@ -0,0 +1,1164 @@
+/* Clock is POSIX, not C99 */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 199309L
+#endif /* _POSIX_C_SOURCE */
+/* syscall for perf_event_open */
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif /* __linux__ */
+
+/* tnecs benchmarks
+**  Sweeps entity & archetype counts, with warmups & repeated runs.
+**  Fragments worlds into 10 to 10k archetypes over 32 or 63 Cs.
+**  Creates & destroys many idle worlds, measures their footprint.
+**  Grows worlds by frames of creates, with & without idle growth.
+**  Reports median & p99 [ns] per operation, as CSV or JSON.
+**
+**  Build: gcc --std=iso9899:1999 -O2 -DNDEBUG bench.c -o bench -lm
+**  Usage: ./bench [-json] [-n max_Es] [scenario ...]
+**      -json:      JSON array instead of CSV
+**      -n max_Es:  Sweep up to max_Es entities, default 10M
+**      -perf:      Hardware counters per op, Linux only.
+**                  Counter reads inflate ns of small batches.
+**      -replay f:  Replay API calls recorded with TNECS_RECORD
+**      -churn pct: Churn scenario: % of Es created, destroyed &
+**                  migrated per frame, default 1
+**      scenario:   Run only listed scenarios, default all
+**  Rows with op rss_kb: samples is the frame, median & p99
+**  are resident set size [KB], Linux only.
+**  Rows with op bytes, allocs: footprint of one world. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#if defined(__linux__)
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#endif /* __linux__ */
+
+#include "tnecs.h"
+#include "tnecs.c"
+
+typedef unsigned long long int u64;
+
+/* --- CONSTANTS --- */
+enum BENCH {
+    BENCH_WARMUPS   =        1,
+    BENCH_RUNS      =        7,
+    BENCH_RUNS_BIG  =        3, /* runs for >= BENCH_BIG Es */
+    BENCH_BIG       =  1000000,
+    BENCH_BATCH     =       64, /* ops per sample */
+    BENCH_STEPS     =       32, /* steps per run */
+    BENCH_MIN_Es    =     1000,
+    BENCH_MAX_Es    = 10000000,
+    BENCH_NUM_C     =        8, /* C_id 1 in all As, 2-7 vary */
+    BENCH_C_ADD     =        8, /* C_id added & removed */
+};
+
+/* --- CLOCK --- */
+#if defined(CLOCK_MONOTONIC)
+u64 bench_ns(void) {
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return ((u64)spec.tv_sec * 1000000000ULL + (u64)spec.tv_nsec);
+}
+#else
+u64 bench_ns(void) {
+    return ((u64)((double)clock() / CLOCKS_PER_SEC * 1e9));
+}
+#endif /* CLOCK_MONOTONIC */
+
+/* --- HARDWARE COUNTERS --- */
+/* One perf_event_open group, read at once. Counters that
+** fail to open are skipped, none if leader fails. */
+enum BENCH_HW {
+    BENCH_HW_CYCLES     = 0,
+    BENCH_HW_INSTR      = 1,
+    BENCH_HW_L1D_MISS   = 2,
+    BENCH_HW_LLC_MISS   = 3,
+    BENCH_HW_BR_MISS    = 4,
+    BENCH_HW_NUM        = 5
+};
+
+static const char *const bench_hw_names[BENCH_HW_NUM] = {
+    "cycles",   "instructions", "l1d_misses",
+    "llc_misses",   "branch_misses"
+};
+
+static int      bench_hw        = 0;
+static int      bench_hw_fd[BENCH_HW_NUM];
+static size_t   bench_hw_O[BENCH_HW_NUM];   /* [hw] order in group */
+static size_t   bench_hw_num    = 0;        /* counters in group  */
+
+#if defined(__linux__)
+int bench_hw_open(void) {
+    static const u64 types[BENCH_HW_NUM] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    static const u64 configs[BENCH_HW_NUM] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int leader = -1;
+    for (size_t hw = 0; hw < BENCH_HW_NUM; hw++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = types[hw];
+        attr.config         = configs[hw];
+        attr.read_format    = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        bench_hw_fd[hw] = syscall(SYS_perf_event_open, &attr, 0, -1,
+                                  leader, 0);
+        if (bench_hw_fd[hw] < 0) {
+            if (hw == BENCH_HW_CYCLES)
+                return (0);
+            continue;
+        }
+        if (hw == BENCH_HW_CYCLES)
+            leader = bench_hw_fd[hw];
+        bench_hw_O[hw] = bench_hw_num++;
+    }
+    return (1);
+}
+
+void bench_hw_read(u64 *hw) {
+    u64 buf[BENCH_HW_NUM + 1] = {0};
+    if (read(bench_hw_fd[BENCH_HW_CYCLES], buf, sizeof(buf)) <= 0)
+        return;
+    for (size_t i = 0; i < BENCH_HW_NUM; i++) {
+        if (bench_hw_fd[i] >= 0)
+            hw[i] = buf[1 + bench_hw_O[i]];
+    }
+}
+
+void bench_hw_close(void) {
+    for (size_t hw = 0; hw < BENCH_HW_NUM; hw++) {
+        if (bench_hw_fd[hw] >= 0)
+            close(bench_hw_fd[hw]);
+    }
+}
+#else
+int  bench_hw_open(void)    { return (0); }
+void bench_hw_read(u64 *hw) {}
+void bench_hw_close(void)   {}
+#endif /* __linux__ */
+
+int bench_hw_valid(size_t hw) {
+    return (bench_hw && (bench_hw_fd[hw] >= 0));
+}
+
+/* --- RANDOM --- */
+/* xorshift64, deterministic across runs */
+static u64 bench_seed = 88172645463325252ULL;
+u64 bench_rand(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return (bench_seed);
+}
+
+/* --- SAMPLES --- */
+typedef struct bench_Samples {
+    size_t num;
+    size_t len;
+
+    double *ns;                 /* [sample] per op  */
+    size_t  ops;                /* in all samples   */
+    u64     hw[BENCH_HW_NUM];   /* in all samples   */
+} bench_Samples;
+
+typedef struct bench_Mark {
+    u64 ns;
+    u64 hw[BENCH_HW_NUM];
+} bench_Mark;
+
+void bench_begin(bench_Mark *m) {
+    if (bench_hw)
+        bench_hw_read(m->hw);
+    m->ns = bench_ns();
+}
+
+void bench_end(bench_Samples *s, const bench_Mark *m, size_t ops) {
+    u64 ns = bench_ns();
+    if (ops == 0)
+        return;
+    if (bench_hw) {
+        u64 hw[BENCH_HW_NUM] = {0};
+        bench_hw_read(hw);
+        for (size_t i = 0; i < BENCH_HW_NUM; i++)
+            s->hw[i] += hw[i] - m->hw[i];
+    }
+    if (s->num >= s->len) {
+        s->len  = (s->len < 64) ? 64 : s->len * 2;
+        s->ns   = realloc(s->ns, s->len * sizeof(*s->ns));
+    }
+    s->ns[s->num++] = (double)(ns - m->ns) / (double)ops;
+    s->ops         += ops;
+}
+
+void bench_reset(bench_Samples *s) {
+    s->num = 0;
+    s->ops = 0;
+    memset(s->hw, 0, sizeof(s->hw));
+}
+
+int bench_cmp(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return ((da > db) - (da < db));
+}
+
+double bench_pct(const bench_Samples *s, size_t pct) {
+    /* Samples must be sorted */
+    if (s->num == 0)
+        return (0.0);
+    size_t i = (s->num * pct) / 100;
+    return (s->ns[(i < s->num) ? i : (s->num - 1)]);
+}
+
+/* --- REPORT --- */
+static int  bench_json  = 0;
+static int  bench_rows  = 0;
+
+void bench_header(void) {
+    if (bench_json) {
+        printf("[\n");
+        return;
+    }
+    printf("scenario,op,Es,As,samples,median_ns,p99_ns");
+    for (size_t hw = 0; hw < BENCH_HW_NUM; hw++)
+        printf(",%s", bench_hw_names[hw]);
+    printf("\n");
+}
+
+void bench_footer(void) {
+    if (bench_json)
+        printf("\n]\n");
+}
+
+void bench_report(const char *scenario, const char *op,
+                  size_t num_Es, size_t num_As, bench_Samples *s) {
+    qsort(s->ns, s->num, sizeof(*s->ns), bench_cmp);
+    double median = bench_pct(s, 50), p99 = bench_pct(s, 99);
+    if (bench_json) {
+        printf("%s{\"scenario\":\"%s\",\"op\":\"%s\",",
+               bench_rows ? ",\n" : "", scenario, op);
+        printf("\"Es\":%zu,\"As\":%zu,\"samples\":%zu,",
+               num_Es, num_As, s->num);
+        printf("\"median_ns\":%.1f,\"p99_ns\":%.1f", median, p99);
+    } else {
+        printf("%s,%s,%zu,%zu,%zu,%.1f,%.1f", scenario, op,
+               num_Es, num_As, s->num, median, p99);
+    }
+
+    /* Counters per op, empty or null if unavailable */
+    for (size_t hw = 0; hw < BENCH_HW_NUM; hw++) {
+        int valid = bench_hw_valid(hw) && (s->ops > 0);
+        double per_op = valid ? (double)s->hw[hw] / s->ops : 0.0;
+        if (bench_json && valid)
+            printf(",\"%s\":%.2f", bench_hw_names[hw], per_op);
+        else if (bench_json)
+            printf(",\"%s\":null", bench_hw_names[hw]);
+        else if (valid)
+            printf(",%.2f", per_op);
+        else
+            printf(",");
+    }
+    printf(bench_json ? "}" : "\n");
+    fflush(stdout);
+    bench_rows++;
+    bench_reset(s);
+}
+
+/* --- COMPONENTS & SYSTEMS --- */
+typedef struct Bench_C {
+    u64 x[4];
+} Bench_C;
+
+void BenchMove(tnecs_In *in) {
+    Bench_C *c = TNECS_In_C(in, 0);
+    for (size_t i = 0; i < in->num_Es; i++)
+        c[i].x[0] += in->dt;
+}
+
+tnecs_W *bench_genesis(void) {
+    tnecs_W *W = NULL;
+    tnecs_genesis(&W);
+    for (size_t C_id = 1; C_id <= BENCH_NUM_C; C_id++)
+        TNECS_REGISTER_C(W, Bench_C, NULL, NULL);
+    TNECS_REGISTER_S(W, BenchMove, 0, 0, 0, (tnecs_C)1);
+    return (W);
+}
+
+tnecs_C bench_A(size_t A_O) {
+    /* A_O-th archetype: C_id 1 & bits of A_O over C_ids 2-7 */
+    tnecs_C A = TNECS_C_ID2T(1);
+    for (size_t bit = 0; bit < (BENCH_NUM_C - 2); bit++) {
+        if (A_O & (1ULL << bit))
+            A |= TNECS_C_ID2T(bit + 2);
+    }
+    return (A);
+}
+
+/* --- SCENARIOS --- */
+enum BENCH_SWEEP_OPS {
+    SWEEP_CREATE    = 0,
+    SWEEP_CREATE_wC = 1,
+    SWEEP_ADD_C     = 2,
+    SWEEP_RM_C      = 3,
+    SWEEP_GET_C     = 4,
+    SWEEP_STEP      = 5,
+    SWEEP_CLONE     = 6,
+    SWEEP_CLONE_COW = 7,
+    SWEEP_DESTROY   = 8,
+    SWEEP_NUM       = 9
+};
+
+void bench_sweep_run(size_t num, size_t num_As,
+                     bench_Samples *s, tnecs_E *Es) {
+    /* One run on a fresh world, one sample per batch of ops */
+    tnecs_W *W = bench_genesis();
+    tnecs_C  C_add = tnecs_C_ids2A(1, (tnecs_C)BENCH_C_ADD);
+    bench_Mark mark;
+
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++)
+            Es[j] = tnecs_E_create(W);
+        bench_end(&s[SWEEP_CREATE], &mark, end - i);
+    }
+    for (size_t i = 0; i < num; i++)
+        tnecs_E_destroy(W, Es[i]);
+
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++) {
+            Es[j] = tnecs_E_create(W);
+            tnecs_E_add_C(W, Es[j], bench_A(j % num_As), 1);
+        }
+        bench_end(&s[SWEEP_CREATE_wC], &mark, end - i);
+    }
+
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++)
+            tnecs_E_add_C(W, Es[j], C_add, 1);
+        bench_end(&s[SWEEP_ADD_C], &mark, end - i);
+    }
+
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++)
+            tnecs_E_rm_C(W, Es[j], C_add);
+        bench_end(&s[SWEEP_RM_C], &mark, end - i);
+    }
+
+    u64 sum = 0;
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++) {
+            Bench_C *c = tnecs_get_C(W, Es[bench_rand() % num], 1);
+            sum += c->x[0];
+        }
+        bench_end(&s[SWEEP_GET_C], &mark, end - i);
+    }
+
+    for (size_t i = 0; i < BENCH_STEPS; i++) {
+        bench_begin(&mark);
+        tnecs_step(W, 1, NULL);
+        bench_end(&s[SWEEP_STEP], &mark, 1);
+    }
+
+    /* One op: whole world */
+    tnecs_W *clone = NULL;
+    for (size_t i = 0; i < BENCH_STEPS; i++) {
+        bench_begin(&mark);
+        tnecs_W_clone(W, &clone);
+        bench_end(&s[SWEEP_CLONE], &mark, 1);
+        tnecs_finale(&clone);
+
+        bench_begin(&mark);
+        tnecs_W_clone_cow(W, &clone);
+        bench_end(&s[SWEEP_CLONE_COW], &mark, 1);
+        tnecs_finale(&clone);
+    }
+
+    for (size_t i = 0; i < num; i += BENCH_BATCH) {
+        size_t end = (i + BENCH_BATCH < num) ? i + BENCH_BATCH : num;
+        bench_begin(&mark);
+        for (size_t j = i; j < end; j++)
+            tnecs_E_destroy(W, Es[j]);
+        bench_end(&s[SWEEP_DESTROY], &mark, end - i);
+    }
+
+    /* Keep get_C from being optimized out */
+    if (sum == 1)
+        fprintf(stderr, " ");
+    tnecs_finale(&W);
+}
+
+void bench_sweep(size_t max_Es) {
+    static const char *const names[SWEEP_NUM] = {
+        "create",   "create_wC",    "add_C",    "rm_C",
+        "get_C",    "step",         "clone",
+        "clone_cow",    "destroy"
+    };
+    static const size_t num_As[] = {1, 8, 64};
+    bench_Samples s[SWEEP_NUM];
+    memset(s, 0, sizeof(s));
+
+    tnecs_E *Es = calloc(max_Es, sizeof(*Es));
+    for (size_t num = BENCH_MIN_Es; num <= max_Es; num *= 10) {
+        size_t runs = (num >= BENCH_BIG) ? BENCH_RUNS_BIG : BENCH_RUNS;
+        for (size_t A = 0; A < sizeof(num_As) / sizeof(*num_As); A++) {
+            for (size_t run = 0; run < BENCH_WARMUPS + runs; run++) {
+                if (run == BENCH_WARMUPS) {
+                    for (size_t op = 0; op < SWEEP_NUM; op++)
+                        bench_reset(&s[op]);
+                }
+                bench_sweep_run(num, num_As[A], s, Es);
+            }
+            for (size_t op = 0; op < SWEEP_NUM; op++)
+                bench_report("sweep", names[op], num, num_As[A], &s[op]);
+        }
+    }
+
+    for (size_t op = 0; op < SWEEP_NUM; op++)
+        free(s[op].ns);
+    free(Es);
+}
+
+/* Fragmentation: num_As distinct archetypes over num_C components */
+enum BENCH_FRAG {
+    FRAG_Es_PER_A   =    4,
+    FRAG_NUM_S      =    8, /* systems on C_id 1-8 */
+    FRAG_GETS       = 4096,
+    FRAG_MIN_Cs     =    2, /* components per archetype */
+    FRAG_MAX_Cs     =    8,
+};
+
+enum BENCH_FRAG_OPS {
+    FRAG_REGISTER   = 0,
+    FRAG_STEP_S     = 1,
+    FRAG_GET_C      = 2,
+    FRAG_NUM        = 3
+};
+
+size_t bench_popcount(tnecs_C A) {
+    size_t num = 0;
+    for (; A; A &= (A - 1))
+        num++;
+    return (num);
+}
+
+void bench_frag_As(tnecs_C *As, size_t num_As, size_t num_C) {
+    /* Distinct random archetypes, hashed in open addressing set */
+    size_t   len = 1;
+    while (len < (num_As * 2))
+        len *= 2;
+    tnecs_C *set = calloc(len, sizeof(*set));
+
+    for (size_t A_O = 0; A_O < num_As; ) {
+        size_t  num_Cs = FRAG_MIN_Cs +
+                         bench_rand() % (FRAG_MAX_Cs - FRAG_MIN_Cs + 1);
+        tnecs_C A = 0;
+        while (bench_popcount(A) < num_Cs)
+            A |= TNECS_C_ID2T(1 + bench_rand() % num_C);
+
+        size_t h = (size_t)((A * 0x9E3779B97F4A7C15ULL) >> 32) & (len - 1);
+        while ((set[h] != 0) && (set[h] != A))
+            h = (h + 1) & (len - 1);
+        if (set[h] == A)
+            continue;
+        set[h]      = A;
+        As[A_O++]   = A;
+    }
+    free(set);
+}
+
+void bench_frag_run(size_t num_As, size_t num_C, tnecs_C *As,
+                    tnecs_E *Es, tnecs_C *Cs, bench_Samples *s) {
+    tnecs_W *W = NULL;
+    tnecs_genesis(&W);
+    for (size_t C_id = 1; C_id <= num_C; C_id++)
+        TNECS_REGISTER_C(W, Bench_C, NULL, NULL);
+    for (size_t C_id = 1; C_id <= FRAG_NUM_S; C_id++)
+        TNECS_REGISTER_S(W, BenchMove, 0, 0, 0, (tnecs_C)C_id);
+
+    /* Registration: first entity of each archetype */
+    bench_Mark mark;
+    for (size_t A_O = 0; A_O < num_As; A_O++) {
+        bench_begin(&mark);
+        Es[A_O] = tnecs_E_create(W);
+        tnecs_E_add_C(W, Es[A_O], As[A_O], 1);
+        bench_end(&s[FRAG_REGISTER], &mark, 1);
+    }
+    size_t num_Es = num_As * FRAG_Es_PER_A;
+    for (size_t i = num_As; i < num_Es; i++) {
+        Es[i] = tnecs_E_create(W);
+        tnecs_E_add_C(W, Es[i], As[i % num_As], 0);
+    }
+    /* Lowest component of each archetype, for get_C */
+    for (size_t i = 0; i < num_Es; i++) {
+        tnecs_C A   = As[i % num_As];
+        tnecs_C low = A & (~A + 1);
+        Cs[i] = TNECS_C_T2ID(low);
+    }
+
+    /* Step: first rebuilds plan */
+    tnecs_step(W, 1, NULL);
+    for (size_t i = 0; i < BENCH_STEPS; i++) {
+        bench_begin(&mark);
+        tnecs_step(W, 1, NULL);
+        bench_end(&s[FRAG_STEP_S], &mark, FRAG_NUM_S);
+    }
+
+    u64 sum = 0;
+    for (size_t i = 0; i < FRAG_GETS; i += BENCH_BATCH) {
+        bench_begin(&mark);
+        for (size_t j = 0; j < BENCH_BATCH; j++) {
+            size_t   r = bench_rand() % num_Es;
+            Bench_C *c = tnecs_get_C(W, Es[r], Cs[r]);
+            sum += c->x[0];
+        }
+        bench_end(&s[FRAG_GET_C], &mark, BENCH_BATCH);
+    }
+
+    /* Keep get_C from being optimized out */
+    if (sum == 1)
+        fprintf(stderr, " ");
+    tnecs_finale(&W);
+}
+
+void bench_frag(size_t max_Es) {
+    (void)max_Es;
+    static const char *const names[FRAG_NUM] = {
+        "register_A",   "step_per_S",   "get_C"
+    };
+    static const size_t num_As[]    = {10, 100, 1000, 10000};
+    static const size_t num_Cs[]    = {32, 63};
+    static const char  *scenarios[] = {"frag32", "frag63"};
+    size_t max_As = num_As[sizeof(num_As) / sizeof(*num_As) - 1];
+
+    bench_Samples s[FRAG_NUM];
+    memset(s, 0, sizeof(s));
+    tnecs_C *As = calloc(max_As, sizeof(*As));
+    tnecs_E *Es = calloc(max_As * FRAG_Es_PER_A, sizeof(*Es));
+    tnecs_C *Cs = calloc(max_As * FRAG_Es_PER_A, sizeof(*Cs));
+
+    for (size_t C = 0; C < sizeof(num_Cs) / sizeof(*num_Cs); C++) {
+        for (size_t A = 0; A < sizeof(num_As) / sizeof(*num_As); A++) {
+            size_t num_Es = num_As[A] * FRAG_Es_PER_A;
+            size_t runs = (num_As[A] >= 10000) ? BENCH_RUNS_BIG : BENCH_RUNS;
+            bench_frag_As(As, num_As[A], num_Cs[C]);
+            for (size_t run = 0; run < BENCH_WARMUPS + runs; run++) {
+                if (run == BENCH_WARMUPS) {
+                    for (size_t op = 0; op < FRAG_NUM; op++)
+                        bench_reset(&s[op]);
+                }
+                bench_frag_run(num_As[A], num_Cs[C], As, Es, Cs, s);
+            }
+            for (size_t op = 0; op < FRAG_NUM; op++)
+                bench_report(scenarios[C], names[op], num_Es,
+                             num_As[A], &s[op]);
+        }
+    }
+
+    for (size_t op = 0; op < FRAG_NUM; op++)
+        free(s[op].ns);
+    free(As);
+    free(Es);
+    free(Cs);
+}
+
+/* Replay: API calls recorded with TNECS_RECORD, on fresh worlds.
+**  Systems are dummies. Recorded Es are mapped to replayed Es. */
+enum BENCH_REPLAY {
+    REPLAY_TOTAL    = 0, /* whole log, [ns] per replay */
+    REPLAY_ARGS     = 5  /* max args per record */
+};
+
+typedef struct bench_Rec {
+    int op;
+    u64 args[REPLAY_ARGS];
+} bench_Rec;
+
+/* Replayed E of recorded index, if recorded generation matches */
+typedef struct bench_Handle {
+    u64     gen;
+    tnecs_E E;
+} bench_Handle;
+
+static const char *const bench_replay_names[] = {
+    "total",        "create",       "destroy",
+    "add_C",        "rm_C",         "step",
+    "register_C",   "register_S",   "register_S_batch",
+    "register_Pi",  "register_Ph",  "reuse_E",
+    "gen_E"
+};
+/* One name per recorded op */
+typedef char bench_replay_names_check[
+    ((sizeof(bench_replay_names) / sizeof(*bench_replay_names)) ==
+     TNECS_REC_NUM) ? 1 : -1];
+
+static const char  *bench_replay_path   = NULL;
+static u64          bench_sink          = 0;
+
+void BenchNop(tnecs_In *in) {
+    bench_sink += in->num_Es;
+}
+
+int bench_rec_u(FILE *f, u64 *u) {
+    /* LEB128 */
+    int byte, shift = 0;
+    *u = 0;
+    do {
+        if (((byte = fgetc(f)) == EOF) || (shift > 63))
+            return (0);
+        *u |= (u64)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return (1);
+}
+
+size_t bench_replay_load(const char *path, bench_Rec **recs) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return (0);
+
+    char magic[sizeof(TNECS_REC_MAGIC)] = {0};
+    size_t magic_len = strlen(TNECS_REC_MAGIC);
+    u64 version = 0;
+    if ((fread(magic, 1, magic_len, f) != magic_len) ||
+        (strcmp(magic, TNECS_REC_MAGIC) != 0) ||
+        !bench_rec_u(f, &version) || (version != TNECS_REC_VERSION)) {
+        fclose(f);
+        return (0);
+    }
+
+    size_t num = 0, len = 0;
+    int op;
+    while ((op = fgetc(f)) != EOF) {
+        int num_args = fgetc(f);
+        if ((op >= TNECS_REC_NUM) || (num_args < 0) ||
+            (num_args > REPLAY_ARGS))
+            break;
+        if (num >= len) {
+            len     = (len < 64) ? 64 : len * 2;
+            *recs   = realloc(*recs, len * sizeof(**recs));
+        }
+        bench_Rec *rec = &(*recs)[num];
+        memset(rec, 0, sizeof(*rec));
+        rec->op = op;
+        int ok = 1;
+        for (int i = 0; i < num_args; i++)
+            ok &= bench_rec_u(f, &rec->args[i]);
+        if (!ok)
+            break;
+        num++;
+    }
+    fclose(f);
+    return (num);
+}
+
+tnecs_E bench_replay_E(const tnecs_W *W, const bench_Handle *map,
+                       size_t map_len, u64 E) {
+    size_t idx = TNECS_E_IDX(W, E);
+    if ((idx >= map_len) || (map[idx].gen != TNECS_E_GEN(E)))
+        return (TNECS_NULL);
+    return (map[idx].E);
+}
+
+int bench_replay_map(const tnecs_W *W, bench_Handle **map, size_t *map_len,
+                     u64 E, tnecs_E out) {
+    /* Indexed by recorded index: generations stay small */
+    size_t idx = TNECS_E_IDX(W, E);
+    while (idx >= *map_len) {
+        size_t olen = *map_len;
+        bench_Handle *grown = realloc(*map, 2 * olen * sizeof(**map));
+        if (grown == NULL)
+            return (0);
+        memset(grown + olen, 0, olen * sizeof(**map));
+        *map        = grown;
+        *map_len    = 2 * olen;
+    }
+    (*map)[idx].gen = TNECS_E_GEN(E);
+    (*map)[idx].E   = out;
+    return (1);
+}
+
+size_t bench_replay_run(const bench_Rec *recs, size_t num,
+                        bench_Samples *s, bench_Handle **map,
+                        size_t *map_len) {
+    tnecs_W *W = NULL;
+    tnecs_genesis(&W);
+    memset(*map, 0, *map_len * sizeof(**map));
+
+    bench_Mark mark, total;
+    bench_begin(&total);
+    for (size_t i = 0; i < num; i++) {
+        const bench_Rec *rec    = &recs[i];
+        const u64       *a      = rec->args;
+        tnecs_E E = bench_replay_E(W, *map, *map_len, a[0]);
+
+        bench_begin(&mark);
+        switch (rec->op) {
+            case TNECS_REC_CREATE:
+                E = tnecs_E_create(W);
+                break;
+            case TNECS_REC_DESTROY:
+                tnecs_E_destroy(W, E);
+                break;
+            case TNECS_REC_ADD_C:
+                tnecs_E_add_C(W, E, a[1], (int)a[2]);
+                break;
+            case TNECS_REC_RM_C:
+                tnecs_E_rm_C(W, E, a[1]);
+                break;
+            case TNECS_REC_STEP:
+                tnecs_step(W, a[0], NULL);
+                break;
+            case TNECS_REC_REGISTER_C:
+                tnecs_register_C(W, a[0], NULL, NULL);
+                break;
+            case TNECS_REC_REGISTER_S:
+                tnecs_register_S(W, BenchNop, a[0], a[1], (int)a[2],
+                                 a[3], a[4]);
+                break;
+            case TNECS_REC_REGISTER_S_BATCH:
+                tnecs_register_S_batch(W, BenchNop, a[0], a[1],
+                                       a[2], a[3]);
+                break;
+            case TNECS_REC_REGISTER_Pi:
+                tnecs_register_Pi(W);
+                break;
+            case TNECS_REC_REGISTER_Ph:
+                tnecs_register_Ph(W, a[0]);
+                break;
+            case TNECS_REC_REUSE_E:
+                tnecs_W_reuse_E(W, (int)a[0]);
+                break;
+            case TNECS_REC_GEN_E:
+                tnecs_W_gen_E(W, (int)a[0]);
+                break;
+        }
+        bench_end(&s[rec->op], &mark, 1);
+
+        /* Map recorded E to replayed E */
+        if ((rec->op == TNECS_REC_CREATE) &&
+            !bench_replay_map(W, map, map_len, a[0], E)) {
+            fprintf(stderr, "bench: replay map allocation failed\n");
+            break;
+        }
+    }
+    bench_end(&s[REPLAY_TOTAL], &total, 1);
+
+    size_t num_As = W->byA.num;
+    tnecs_finale(&W);
+    return (num_As);
+}
+
+void bench_replay(size_t max_Es) {
+    (void)max_Es;
+    if (bench_replay_path == NULL)
+        return;
+
+    bench_Rec *recs = NULL;
+    size_t num = bench_replay_load(bench_replay_path, &recs);
+    if (num == 0) {
+        fprintf(stderr, "bench: could not replay '%s'\n",
+                bench_replay_path);
+        free(recs);
+        return;
+    }
+
+    size_t num_Es = 0;
+    for (size_t i = 0; i < num; i++)
+        num_Es += (recs[i].op == TNECS_REC_CREATE);
+
+    bench_Samples s[TNECS_REC_NUM];
+    memset(s, 0, sizeof(s));
+    size_t   map_len = 1024, num_As = 0;
+    bench_Handle *map   = calloc(map_len, sizeof(*map));
+    if (map == NULL) {
+        free(recs);
+        return;
+    }
+    for (size_t run = 0; run < BENCH_WARMUPS + BENCH_RUNS; run++) {
+        if (run == BENCH_WARMUPS) {
+            for (size_t op = 0; op < TNECS_REC_NUM; op++)
+                bench_reset(&s[op]);
+        }
+        num_As = bench_replay_run(recs, num, s, &map, &map_len);
+    }
+    for (size_t op = 0; op < TNECS_REC_NUM; op++) {
+        if (s[op].num > 0)
+            bench_report("replay", bench_replay_names[op], num_Es, num_As,
+                         &s[op]);
+        free(s[op].ns);
+    }
+
+    if (bench_sink == 1)
+        fprintf(stderr, " ");
+    free(map);
+    free(recs);
+}
+
+/* Churn: steady population, % created, destroyed & migrated
+**  per frame, with & without reusing Es. */
+enum BENCH_CHURN {
+    CHURN_Es        = 1000000,
+    CHURN_FRAMES    =     600,
+    CHURN_RSS_EVERY =      60, /* frames */
+    CHURN_NUM_As    =       8,
+};
+
+enum BENCH_CHURN_OPS {
+    CHURN_FRAME     = 0,
+    CHURN_DESTROY   = 1,
+    CHURN_CREATE    = 2,
+    CHURN_MIGRATE   = 3,
+    CHURN_STEP      = 4,
+    CHURN_NUM       = 5
+};
+
+static double bench_churn_pct = 1.0;
+
+size_t bench_rss_kb(void) {
+    /* statm: size resident ... in pages */
+    size_t rss = 0;
+#if defined(__linux__)
+    unsigned long size, pages;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f == NULL)
+        return (0);
+    if (fscanf(f, "%lu %lu", &size, &pages) == 2)
+        rss = pages * (sysconf(_SC_PAGESIZE) / 1024);
+    fclose(f);
+#endif /* __linux__ */
+    return (rss);
+}
+
+void bench_report_val(const char *scenario, const char *op,
+                      size_t num_Es, size_t num_As,
+                      size_t samples, size_t val) {
+    /* Not a time: median & p99 columns are val */
+    if (bench_json) {
+        printf("%s{\"scenario\":\"%s\",\"op\":\"%s\",",
+               bench_rows ? ",\n" : "", scenario, op);
+        printf("\"Es\":%zu,\"As\":%zu,\"samples\":%zu,",
+               num_Es, num_As, samples);
+        printf("\"median_ns\":%zu,\"p99_ns\":%zu", val, val);
+    } else {
+        printf("%s,%s,%zu,%zu,%zu,%zu,%zu", scenario, op,
+               num_Es, num_As, samples, val, val);
+    }
+    for (size_t hw = 0; hw < BENCH_HW_NUM; hw++) {
+        if (bench_json)
+            printf(",\"%s\":null", bench_hw_names[hw]);
+        else
+            printf(",");
+    }
+    printf(bench_json ? "}" : "\n");
+    fflush(stdout);
+    bench_rows++;
+}
+
+void bench_churn_run(size_t num, int reuse, bench_Samples *s,
+                     tnecs_E *Es) {
+    static const char *const scenarios[2] = {"churn", "churn_reuse"};
+    tnecs_W *W      = bench_genesis();
+    tnecs_C  C_add  = tnecs_C_ids2A(1, (tnecs_C)BENCH_C_ADD);
+    tnecs_W_reuse_E(W, reuse);
+
+    for (size_t i = 0; i < num; i++) {
+        Es[i] = tnecs_E_create(W);
+        tnecs_E_add_C(W, Es[i], bench_A(i % CHURN_NUM_As), 1);
+    }
+
+    size_t churn = (size_t)(num * bench_churn_pct / 100.0);
+    churn = (churn < 1) ? 1 : churn;
+    bench_Mark frame, mark;
+    for (size_t f = 0; f < CHURN_FRAMES; f++) {
+        bench_begin(&frame);
+
+        /* Destroy, then refill same slots */
+        size_t first = bench_rand() % num;
+        bench_begin(&mark);
+        for (size_t i = 0; i < churn; i++)
+            tnecs_E_destroy(W, Es[(first + i * 7919) % num]);
+        bench_end(&s[CHURN_DESTROY], &mark, churn);
+
+        bench_begin(&mark);
+        for (size_t i = 0; i < churn; i++) {
+            size_t slot = (first + i * 7919) % num;
+            Es[slot] = tnecs_E_create(W);
+            tnecs_E_add_C(W, Es[slot],
+                          bench_A(bench_rand() % CHURN_NUM_As), 1);
+        }
+        bench_end(&s[CHURN_CREATE], &mark, churn);
+
+        /* Migrate: toggle C_add */
+        bench_begin(&mark);
+        for (size_t i = 0; i < churn; i++) {
+            tnecs_E E = Es[bench_rand() % num];
+            if (W->Es.As[E] & C_add)
+                tnecs_E_rm_C(W, E, C_add);
+            else
+                tnecs_E_add_C(W, E, C_add, 1);
+        }
+        bench_end(&s[CHURN_MIGRATE], &mark, churn);
+
+        bench_begin(&mark);
+        tnecs_step(W, 1, NULL);
+        bench_end(&s[CHURN_STEP], &mark, 1);
+
+        bench_end(&s[CHURN_FRAME], &frame, 1);
+
+        if ((f % CHURN_RSS_EVERY) == (CHURN_RSS_EVERY - 1))
+            bench_report_val(scenarios[reuse], "rss_kb", num,
+                             CHURN_NUM_As, f + 1, bench_rss_kb());
+    }
+    tnecs_finale(&W);
+}
+
+void bench_churn(size_t max_Es) {
+    static const char *const names[CHURN_NUM] = {
+        "frame", "destroy", "create", "migrate", "step"
+    };
+    static const char *const scenarios[2] = {"churn", "churn_reuse"};
+    size_t num = (max_Es < CHURN_Es) ? max_Es : CHURN_Es;
+    bench_Samples s[CHURN_NUM];
+    memset(s, 0, sizeof(s));
+
+    tnecs_E *Es = calloc(num, sizeof(*Es));
+    for (int reuse = 0; reuse < 2; reuse++) {
+        bench_churn_run(num, reuse, s, Es);
+        for (size_t op = 0; op < CHURN_NUM; op++)
+            bench_report(scenarios[reuse], names[op], num,
+                         CHURN_NUM_As, &s[op]);
+    }
+
+    for (size_t op = 0; op < CHURN_NUM; op++)
+        free(s[op].ns);
+    free(Es);
+}
+
+/* Growth: Es created in frames, from empty world.
+**  Creates grow arrays, or tnecs_W_idle does between frames.
+**  Per frame [ns]: median, p99 & max. */
+enum BENCH_GROWTH {
+    GROWTH_Es       = 1000000,
+    GROWTH_FRAME    =    1000, /* Es created per frame */
+    GROWTH_IDLE     =  1 << 25 /* bytes per idle: fits Es table growth */
+};
+
+enum BENCH_GROWTH_OPS {
+    GROWTH_CREATE   = 0,
+    GROWTH_IDLES    = 1,
+    GROWTH_NUM      = 2
+};
+
+void bench_growth(size_t max_Es) {
+    static const char *const names[GROWTH_NUM] = {"create", "idle"};
+    static const char *const scenarios[2] = {"growth", "growth_idle"};
+    size_t num = (max_Es < GROWTH_Es) ? max_Es : GROWTH_Es;
+    bench_Samples s[GROWTH_NUM];
+    memset(s, 0, sizeof(s));
+
+    for (int idle = 0; idle < 2; idle++) {
+        tnecs_W *W = bench_genesis();
+        bench_Mark mark;
+        for (size_t E = 0; E < num; E += GROWTH_FRAME) {
+            bench_begin(&mark);
+            for (size_t i = 0; i < GROWTH_FRAME; i++) {
+                tnecs_E Ei = tnecs_E_create(W);
+                tnecs_E_add_C(W, Ei, bench_A(i % CHURN_NUM_As), 1);
+            }
+            bench_end(&s[GROWTH_CREATE], &mark, 1);
+            if (!idle)
+                continue;
+            bench_begin(&mark);
+            tnecs_W_idle(W, GROWTH_IDLE);
+            bench_end(&s[GROWTH_IDLES], &mark, 1);
+        }
+        tnecs_finale(&W);
+
+        for (size_t op = 0; op <= (size_t)idle; op++) {
+            double max = 0.0;
+            for (size_t i = 0; i < s[op].num; i++)
+                max = (s[op].ns[i] > max) ? s[op].ns[i] : max;
+            size_t frames = s[op].num;
+            bench_report(scenarios[idle], names[op], num,
+                         CHURN_NUM_As, &s[op]);
+            char op_max[32];
+            sprintf(op_max, "%s_max", names[op]);
+            bench_report_val(scenarios[idle], op_max, num,
+                             CHURN_NUM_As, frames, (size_t)max);
+        }
+    }
+
+    for (size_t op = 0; op < GROWTH_NUM; op++)
+        free(s[op].ns);
+}
+
+/* Genesis: many small idle worlds, e.g. one per match room.
+**  Time of genesis & finale, footprint of one world. */
+enum BENCH_GENESIS {
+    GENESIS_Ws      = 1024, /* per run */
+};
+
+enum BENCH_GENESIS_OPS {
+    GENESIS_GENESIS = 0,
+    GENESIS_FINALE  = 1,
+    GENESIS_NUM     = 2
+};
+
+typedef struct bench_Count {
+    /* Live */
+    size_t bytes;
+    size_t allocs;
+} bench_Count;
+
+void *bench_count_alloc(void *ctx, size_t bytes) {
+    bench_Count *count = ctx;
+    count->bytes += bytes;
+    count->allocs++;
+    return (calloc(1, bytes));
+}
+
+void bench_count_free(void *ctx, void *ptr, size_t bytes) {
+    bench_Count *count = ctx;
+    count->bytes -= bytes;
+    count->allocs--;
+    free(ptr);
+}
+
+void bench_room_W(tnecs_W **W, const tnecs_Alloc *alloc, int regis) {
+    /* regis: room setup, Cs & a system */
+    tnecs_genesis_alloc(W, alloc);
+    if (!regis)
+        return;
+    for (size_t C_id = 1; C_id <= BENCH_NUM_C; C_id++)
+        TNECS_REGISTER_C(*W, Bench_C, NULL, NULL);
+    TNECS_REGISTER_S(*W, BenchMove, 0, 0, 0, (tnecs_C)1);
+}
+
+void bench_rooms(size_t max_Es) {
+    (void)max_Es;
+    static const char *const names[GENESIS_NUM] = {"genesis", "finale"};
+    static const char *const scenarios[2] = {"genesis", "genesis_regis"};
+    bench_Samples s[GENESIS_NUM];
+    memset(s, 0, sizeof(s));
+    bench_Count count = {0};
+    tnecs_Alloc alloc = {bench_count_alloc, NULL, bench_count_free, &count};
+    tnecs_W **Ws = calloc(GENESIS_Ws, sizeof(*Ws));
+
+    bench_Mark mark;
+    for (int regis = 0; regis < 2; regis++) {
+        for (size_t run = 0; run < BENCH_WARMUPS + BENCH_RUNS; run++) {
+            if (run == BENCH_WARMUPS) {
+                for (size_t op = 0; op < GENESIS_NUM; op++)
+                    bench_reset(&s[op]);
+            }
+            for (size_t i = 0; i < GENESIS_Ws; i += BENCH_BATCH) {
+                bench_begin(&mark);
+                for (size_t j = i; j < i + BENCH_BATCH; j++)
+                    bench_room_W(&Ws[j], NULL, regis);
+                bench_end(&s[GENESIS_GENESIS], &mark, BENCH_BATCH);
+            }
+            for (size_t i = 0; i < GENESIS_Ws; i += BENCH_BATCH) {
+                bench_begin(&mark);
+                for (size_t j = i; j < i + BENCH_BATCH; j++)
+                    tnecs_finale(&Ws[j]);
+                bench_end(&s[GENESIS_FINALE], &mark, BENCH_BATCH);
+            }
+        }
+        for (size_t op = 0; op < GENESIS_NUM; op++)
+            bench_report(scenarios[regis], names[op], 0, 0, &s[op]);
+
+        /* Footprint: counted by the allocator */
+        bench_room_W(&Ws[0], &alloc, regis);
+        bench_report_val(scenarios[regis], "bytes",  0, 0, 1, count.bytes);
+        bench_report_val(scenarios[regis], "allocs", 0, 0, 1, count.allocs);
+        tnecs_finale(&Ws[0]);
+    }
+
+    for (size_t op = 0; op < GENESIS_NUM; op++)
+        free(s[op].ns);
+    free(Ws);
+}
+
+/* --- MAIN --- */
+typedef struct bench_Scenario {
+    const char *name;
+    void (*run)(size_t max_Es);
+} bench_Scenario;
+
+static const bench_Scenario bench_scenarios[] = {
+    {"sweep",   bench_sweep},
+    {"frag",    bench_frag},
+    {"replay",  bench_replay},
+    {"churn",   bench_churn},
+    {"growth",  bench_growth},
+    {"genesis", bench_rooms},
+};
+
+int main(int argc, char *argv[]) {
+    size_t max_Es   = BENCH_MAX_Es;
+    int    only     = 0;
+    size_t num_scenarios = sizeof(bench_scenarios) / sizeof(*bench_scenarios);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-json") == 0)
+            bench_json = 1;
+        else if (strcmp(argv[i], "-perf") == 0)
+            bench_hw = 1;
+        else if ((strcmp(argv[i], "-replay") == 0) && (i + 1 < argc))
+            bench_replay_path = argv[++i], only = 1;
+        else if ((strcmp(argv[i], "-churn") == 0) && (i + 1 < argc))
+            bench_churn_pct = strtod(argv[++i], NULL);
+        else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+            max_Es = strtoull(argv[++i], NULL, 10);
+        else
+            only = 1;
+    }
+
+    if (bench_hw && !bench_hw_open()) {
+        fprintf(stderr, "bench: hardware counters unavailable\n");
+        bench_hw = 0;
+    }
+
+    bench_header();
+    for (size_t i = 0; i < num_scenarios; i++) {
+        int run = !only;
+        if ((bench_scenarios[i].run == bench_replay) && bench_replay_path)
+            run = 1;
+        for (int j = 1; j < argc; j++) {
+            if (strcmp(argv[j], bench_scenarios[i].name) == 0)
+                run = 1;
+        }
+        if (run)
+            bench_scenarios[i].run(max_Es);
+    }
+    bench_footer();
+    if (bench_hw)
+        bench_hw_close();
+    return (0);
+}
@@ -203,27 +203,12 @@ typedef struct Unit2 {
     u64 res;
 } Unit2;
 
-void SystemMove2(struct tnecs_In *input) {
-    int     Position2_ID    = 1;
-    int     Unit2_ID        = 2;
-    struct  Position2   *p = NULL;
-    struct  Unit2       *v = NULL;
-
-    p = TNECS_C_ARRAY(input, Position2_ID);
-    v = TNECS_C_ARRAY(input, Unit2_ID);
-
-    for (int i = 0; i < input->num_Es; i++) {
-        p[i].x += v[i].hp;
-        p[i].y += v[i].str;
-    }
-}
-
 void SystemMovePhase1(struct tnecs_In *input) {
     for (int ent = 0; ent < input->num_Es; ent++) {
-        tnecs_E current_ent = input->world->byA.Es[input->E_A_id][ent];
+        tnecs_E current_ent = input->world->byA.arr[input->E_A_id].Es[ent];
         test_true(current_ent);
-        test_true(input->world->Es.id[input->world->byA.Es[input->E_A_id][ent]]
-            == input->world->byA.Es[input->E_A_id][ent]);
+        test_true(input->world->Es.id[input->world->byA.arr[input->E_A_id].Es[ent]]
+            == input->world->byA.arr[input->E_A_id].Es[ent]);
         test_true(input->E_A_id == tnecs_A_id(input->world,
                                                              input->world->Es.As[current_ent]));
     }
@@ -231,10 +216,10 @@ void SystemMovePhase1(struct tnecs_In *input) {
 
 void SystemMovePhase4(struct tnecs_In *input) {
     for (int ent = 0; ent < input->num_Es; ent++) {
-        tnecs_E current_ent = input->world->byA.Es[input->E_A_id][ent];
+        tnecs_E current_ent = input->world->byA.arr[input->E_A_id].Es[ent];
         test_true(current_ent);
-        test_true(input->world->Es.id[input->world->byA.Es[input->E_A_id][ent]]
-            == input->world->byA.Es[input->E_A_id][ent]);
+        test_true(input->world->Es.id[input->world->byA.arr[input->E_A_id].Es[ent]]
+            == input->world->byA.arr[input->E_A_id].Es[ent]);
         test_true(input->E_A_id == tnecs_A_id(input->world,
                                                              input->world->Es.As[current_ent]));
     }
@@ -242,21 +227,19 @@ void SystemMovePhase4(struct tnecs_In *input) {
 
 void SystemMovePhase2(struct tnecs_In *input) {
     for (int ent = 0; ent < input->num_Es; ent++) {
-        tnecs_E current_ent = input->world->byA.Es[input->E_A_id][ent];
+        tnecs_E current_ent = input->world->byA.arr[input->E_A_id].Es[ent];
         test_true(current_ent);
-        test_true(input->world->Es.id[input->world->byA.Es[input->E_A_id][ent]]
-            == input->world->byA.Es[input->E_A_id][ent]);
+        test_true(input->world->Es.id[input->world->byA.arr[input->E_A_id].Es[ent]]
+            == input->world->byA.arr[input->E_A_id].Es[ent]);
         test_true(input->E_A_id == tnecs_A_id(input->world,
                                                              input->world->Es.As[current_ent]));
     }
 }
 
 /*****************************TEST CONSTANTS***************************/
-#define ITERATIONS 10000
 size_t fps_iterations = 10;
 
 /*******************************TEST SYSTEMS***************************/
-tnecs_E test_Es[ITERATIONS];
 tnecs_E        *Cs_list;
 struct Position     *temp_position;
 struct Unit         *temp_unit;
@@ -273,10 +256,10 @@ void SystemMove(struct tnecs_In *input) {
     v = TNECS_C_ARRAY(input, Velocity_ID);
 
     for (int ent = 0; ent < input->num_Es; ent++) {
-        tnecs_E current_ent = input->world->byA.Es[input->E_A_id][ent];
+        tnecs_E current_ent = input->world->byA.arr[input->E_A_id].Es[ent];
         test_true(current_ent);
-        test_true(input->world->Es.id[input->world->byA.Es[input->E_A_id][ent]]
-            == input->world->byA.Es[input->E_A_id][ent]);
+        test_true(input->world->Es.id[input->world->byA.arr[input->E_A_id].Es[ent]]
+            == input->world->byA.arr[input->E_A_id].Es[ent]);
         test_true(input->E_A_id == tnecs_A_id(input->world,
                                                              input->world->Es.As[current_ent]));
 
@@ -353,12 +336,12 @@ void tnecs_test_C_registration() {
     size_t temp_A_id    = 1;
     size_t temp_archetype       = 1;
     test_true(TNECS_C_ID2T(temp_comp_id) == temp_archetype);
-    assert(test_world->byA.Cs_id != NULL);
-    assert(test_world->byA.Cs_id[temp_comp_id] != NULL);
-    test_true(test_world->byA.Cs_id[temp_A_id][temp_comp_order] == temp_comp_id);
-    test_true(test_world->byA.A[0] == 0);
-    test_true(test_world->byA.A[1] == (TNECS_NULLSHIFT << 0));
-    test_true(test_world->byA.A[1] == temp_comp_flag);
+    assert(test_world->byA.arr != NULL);
+    assert(test_world->byA.arr[temp_comp_id].Cs_id != NULL);
+    test_true(test_world->byA.arr[temp_A_id].Cs_id[temp_comp_order] == temp_comp_id);
+    test_true(test_world->byA.arr[0].A == 0);
+    test_true(test_world->byA.arr[1].A == (TNECS_NULLSHIFT << 0));
+    test_true(test_world->byA.arr[1].A == temp_comp_flag);
     test_true(test_world->Cs.num == 2);
 
     TNECS_REGISTER_C(test_world, Unit, NULL, NULL);
@@ -368,11 +351,11 @@ void tnecs_test_C_registration() {
     temp_A_id = 2;
     temp_archetype = 2;
     test_true(TNECS_C_ID2T(temp_comp_id) == temp_archetype);
-    test_true(test_world->byA.Cs_id[temp_comp_id][temp_comp_order] == temp_comp_id);
-    test_true(test_world->byA.A[0] == 0);
-    test_true(test_world->byA.A[1] == (TNECS_NULLSHIFT << 0));
-    test_true(test_world->byA.A[2] == (TNECS_NULLSHIFT << 1));
-    test_true(test_world->byA.A[2] == temp_comp_flag);
+    test_true(test_world->byA.arr[temp_comp_id].Cs_id[temp_comp_order] == temp_comp_id);
+    test_true(test_world->byA.arr[0].A == 0);
+    test_true(test_world->byA.arr[1].A == (TNECS_NULLSHIFT << 0));
+    test_true(test_world->byA.arr[2].A == (TNECS_NULLSHIFT << 1));
+    test_true(test_world->byA.arr[2].A == temp_comp_flag);
     test_true(test_world->Cs.num == 3);
 
     TNECS_REGISTER_C(test_world, Sprite, NULL, NULL);
@@ -382,11 +365,11 @@ void tnecs_test_C_registration() {
     temp_A_id = 3;
     temp_archetype = 4;
     test_true(TNECS_C_ID2T(temp_comp_id) == temp_archetype);
-    test_true(test_world->byA.A[0] == 0);
-    test_true(test_world->byA.A[1] == (TNECS_NULLSHIFT << 0));
-    test_true(test_world->byA.A[2] == (TNECS_NULLSHIFT << 1));
-    test_true(test_world->byA.A[3] == (TNECS_NULLSHIFT << 2));
-    test_true(test_world->byA.A[3] == temp_comp_flag);
+    test_true(test_world->byA.arr[0].A == 0);
+    test_true(test_world->byA.arr[1].A == (TNECS_NULLSHIFT << 0));
+    test_true(test_world->byA.arr[2].A == (TNECS_NULLSHIFT << 1));
+    test_true(test_world->byA.arr[3].A == (TNECS_NULLSHIFT << 2));
+    test_true(test_world->byA.arr[3].A == temp_comp_flag);
     test_true(test_world->Cs.num == 4);
 
     TNECS_REGISTER_C(test_world, Velocity, NULL, NULL);
@@ -396,14 +379,14 @@ void tnecs_test_C_registration() {
     temp_A_id = 4;
     temp_archetype = 8;
     test_true(TNECS_C_ID2T(temp_comp_id) == temp_archetype);
-    test_true(test_world->byA.Cs_id[temp_comp_id][temp_comp_order] == temp_comp_id);
-
-    test_true(test_world->byA.A[0] == 0);
-    test_true(test_world->byA.A[1] == (TNECS_NULLSHIFT << 0));
-    test_true(test_world->byA.A[2] == (TNECS_NULLSHIFT << 1));
-    test_true(test_world->byA.A[3] == (TNECS_NULLSHIFT << 2));
-    test_true(test_world->byA.A[4] == (TNECS_NULLSHIFT << 3));
-    test_true(test_world->byA.A[4] == temp_comp_flag);
+    test_true(test_world->byA.arr[temp_comp_id].Cs_id[temp_comp_order] == temp_comp_id);
+
+    test_true(test_world->byA.arr[0].A == 0);
+    test_true(test_world->byA.arr[1].A == (TNECS_NULLSHIFT << 0));
+    test_true(test_world->byA.arr[2].A == (TNECS_NULLSHIFT << 1));
+    test_true(test_world->byA.arr[3].A == (TNECS_NULLSHIFT << 2));
+    test_true(test_world->byA.arr[4].A == (TNECS_NULLSHIFT << 3));
+    test_true(test_world->byA.arr[4].A == temp_comp_flag);
     test_true(test_world->Cs.num == 5);
 
     int Position_ID = 1;
@@ -421,8 +404,8 @@ void tnecs_test_system_registration() {
     TNECS_REGISTER_S(test_world, SystemMove, pipe0, 0, 1, Position_ID, Velocity_ID);
     size_t temp_A_id    = 5;
 
-    test_true(test_world->byA.Cs_id[temp_A_id][0] == Position_ID);
-    test_true(test_world->byA.Cs_id[temp_A_id][1] == Velocity_ID);
+    test_true(test_world->byA.arr[temp_A_id].Cs_id[0] == Position_ID);
+    test_true(test_world->byA.arr[temp_A_id].Cs_id[1] == Velocity_ID);
 }
 
 void tnecs_test_E_creation() {
@@ -513,8 +496,9 @@ void tnecs_test_E_creation() {
     int Unit2_ID     = 2;
 
     TNECS_REGISTER_C(test_world2, Position2, NULL, NULL);
-    test_world2->Pis.byPh[0].num_Ss[0] = TNECS_Ph_0LEN;
-    TNECS_REGISTER_S(test_world2, SystemMovePhase1, pipe0, 0, 0, Position2_ID);
+    for (size_t i = 0; i <= TNECS_Ph_0LEN; i++)
+        TNECS_REGISTER_S(test_world2, SystemMovePhase1, pipe0, 0, 0, Position2_ID);
+    test_true(test_world2->Pis.byPh[0].len_Ss[0] > TNECS_Ph_0LEN);
     tnecs_finale(&test_world2);
 
     // Coverage for "for" in tnecs_C_del
@@ -732,39 +716,39 @@ void tnecs_test_C_array() {
 
     size_t temp_C_O = tnecs_C_O_byAid(arr_world, Position_ID, temp_archetypeid);
     assert(temp_archetypeid > TNECS_NULL);
-    assert(arr_world->byA.Cs != NULL);
-    assert(arr_world->byA.Cs[temp_archetypeid] != NULL);
+    assert(arr_world->byA.arr != NULL);
+    assert(arr_world->byA.arr[temp_archetypeid].Cs != NULL);
 
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 4);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 4);
     temp_C_O = tnecs_C_O_byAid(arr_world, Unit_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 4);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 4);
 
     temp_archetypeid = TNECS_C_IDS2AID(arr_world, Unit_ID, Velocity_ID);
     temp_C_O = tnecs_C_O_byAid(arr_world, Unit_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 3);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 3);
     temp_C_O = tnecs_C_O_byAid(arr_world, Velocity_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 3);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 3);
 
     temp_archetypeid = TNECS_C_IDS2AID(arr_world, Unit_ID, Velocity_ID, Position_ID);
     temp_C_O = tnecs_C_O_byAid(arr_world, Unit_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 2);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 2);
     temp_C_O = tnecs_C_O_byAid(arr_world, Position_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 2);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 2);
     temp_C_O = tnecs_C_O_byAid(arr_world, Velocity_ID, temp_archetypeid);
-    test_true(arr_world->byA.Cs[temp_archetypeid][temp_C_O].num == 2);
+    test_true(arr_world->byA.arr[temp_archetypeid].Cs[temp_C_O].num == 2);
 
     size_t old_E_order = arr_world->Es.Os[temp_ent];
     test_true(old_E_order == 0);
     test_true(arr_world->Es.As[temp_ent] == TNECS_C_IDS2A(Unit_ID));
     size_t old_archetypeid = TNECS_C_IDS2AID(arr_world, Unit_ID);
-    test_true(arr_world->byA.num_Es[old_archetypeid] == 1);
+    test_true(arr_world->byA.arr[old_archetypeid].num_Es == 1);
     test_true(old_archetypeid == Unit_ID);
     size_t old_C_O = tnecs_C_O_byAid(arr_world, Unit_ID, old_archetypeid);
 
     test_true(old_C_O < TNECS_C_CAP);
     test_true(old_C_O == 0);
 
-    test_true(arr_world->byA.Cs[old_archetypeid][old_C_O].num == 1);
+    test_true(arr_world->byA.arr[old_archetypeid].Cs[old_C_O].num == 1);
 
     struct Unit     *temp_unit  = tnecs_get_C(arr_world, temp_ent, Unit_ID);
     struct Position *temp_pos   = tnecs_get_C(arr_world, temp_ent, Position_ID);
@@ -787,17 +771,17 @@ void tnecs_test_C_array() {
     test_true(temp_unit->str  == 12);
 
     size_t new_archetypeid = TNECS_C_IDS2AID(arr_world, Unit_ID, Position_ID);
-    test_true(arr_world->byA.num_Es[new_archetypeid] == 4);
+    test_true(arr_world->byA.arr[new_archetypeid].num_Es == 4);
     TNECS_ADD_C(arr_world, temp_ent, Position_ID);
     
     temp_unit = tnecs_get_C(arr_world, temp_ent, Unit_ID);
     test_true(temp_unit->hp   == 10);
     test_true(temp_unit->str  == 12);
 
-    test_true(arr_world->byA.num_Es[old_archetypeid] == 0);
+    test_true(arr_world->byA.arr[old_archetypeid].num_Es == 0);
     test_true(arr_world->Es.As[temp_ent] == TNECS_C_IDS2A(Unit_ID,
             Position_ID));
-    test_true(arr_world->byA.num_Es[new_archetypeid] == 5);
+    test_true(arr_world->byA.arr[new_archetypeid].num_Es == 5);
     temp_unit = tnecs_get_C(arr_world, temp_ent, Unit_ID);
     test_true(temp_unit->hp   == 10);
     test_true(temp_unit->str  == 12);
@@ -836,7 +820,7 @@ void tnecs_test_world_progress() {
     test_true(!TNECS_E_HAS_C(test_world, Perignon, Unit_ID));
 
     test_true(test_world->Es.As[Perignon] == (1 + 2));
-    test_true(test_world->byA.num_Es[tnecs_A_id(test_world, 1 + 2)] == 1);
+    test_true(test_world->byA.arr[tnecs_A_id(test_world, 1 + 2)].num_Es == 1);
 
     temp_position = tnecs_get_C(test_world, Perignon, Position_ID);
     temp_velocity = tnecs_get_C(test_world, Perignon, Velocity_ID);
@@ -898,7 +882,7 @@ void tnecs_test_world_progress() {
     tnecs_step(test_world, 0, NULL);
 
     test_true(test_world->Es.As[Perignon] == (1 + 2));
-    test_true(test_world->byA.num_Es[tnecs_A_id(test_world, 1 + 2)] == 1);
+    test_true(test_world->byA.arr[tnecs_A_id(test_world, 1 + 2)].num_Es == 1);
     tnecs_E_destroy(test_world, Perignon);
 
     tnecs_grow_Ph(test_world, 0);
@@ -924,31 +908,31 @@ void tnecs_test_world_progress() {
     test_true(TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID) == 4 + 1);
     test_true(TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID) == 4 + 2 + 1);
 
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world,
-                                                            TNECS_S_ID2A(inclusive_world, SystemMove_ID))] == 3);
-    test_true(inclusive_world->byA.subA[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))][0] == tnecs_A_id(inclusive_world,
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                            TNECS_S_ID2A(inclusive_world, SystemMove_ID))].num_A_ids == 3);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))].subA[0] == tnecs_A_id(inclusive_world,
                                                                       TNECS_S_ID2A(inclusive_world, SystemMovePhase1_ID)));
-    test_true(inclusive_world->byA.subA[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))][1] == tnecs_A_id(inclusive_world,
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))].subA[1] == tnecs_A_id(inclusive_world,
                                                                       TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID)));
-    test_true(inclusive_world->byA.subA[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))][2] == tnecs_A_id(inclusive_world,
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))].subA[2] == tnecs_A_id(inclusive_world,
                                                                       TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID)));
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world,
-                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase1_ID))] == 1);
-    test_true(inclusive_world->byA.subA[tnecs_A_id(inclusive_world,
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase1_ID))].num_A_ids == 1);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
                                                               TNECS_S_ID2A(inclusive_world,
-                                                                      SystemMovePhase1_ID))][0] == tnecs_A_id(inclusive_world,
+                                                                      SystemMovePhase1_ID))].subA[0] == tnecs_A_id(inclusive_world,
                                                                               TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID)));
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world,
-                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID))] == 1);
-    test_true(inclusive_world->byA.subA[tnecs_A_id(inclusive_world,
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID))].num_A_ids == 1);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
                                                               TNECS_S_ID2A(inclusive_world,
-                                                                      SystemMovePhase2_ID))][0] == tnecs_A_id(inclusive_world,
+                                                                      SystemMovePhase2_ID))].subA[0] == tnecs_A_id(inclusive_world,
                                                                               TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID)));
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world,
-                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID))] == 0);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                            TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID))].num_A_ids == 0);
 
     test_true(inclusive_world->byA.num == 8);
     TNECS_E_CREATE_wC(inclusive_world, Unit_ID);
@@ -982,14 +966,14 @@ void tnecs_test_world_progress() {
     TNECS_E_CREATE_wC(inclusive_world, Unit_ID, Position_ID, Velocity_ID);
     TNECS_E_CREATE_wC(inclusive_world, Unit_ID, Position_ID, Velocity_ID);
     TNECS_E_CREATE_wC(inclusive_world, Unit_ID, Position_ID, Velocity_ID);
-    test_true(inclusive_world->byA.num_Es[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))] == 9);
-    test_true(inclusive_world->byA.num_Es[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase1_ID))] == 2);
-    test_true(inclusive_world->byA.num_Es[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID))] == 6);
-    test_true(inclusive_world->byA.num_Es[tnecs_A_id(inclusive_world,
-                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID))] == 12);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMove_ID))].num_Es == 9);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase1_ID))].num_Es == 2);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID))].num_Es == 6);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world,
+                                                              TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID))].num_Es == 12);
     test_true(inclusive_world->byA.num == 8);
     tnecs_step(inclusive_world, 1, NULL);
 
@@ -1031,14 +1015,14 @@ void tnecs_test_world_progress() {
     test_true(TNECS_S_ID2A(inclusive_world, SystemMovePhase2_ID) == 4 + 1);
     test_true(TNECS_S_ID2A(inclusive_world, SystemMovePhase4_ID) == 4 + 2 + 1);
 
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world2,
-                                                            TNECS_S_ID2A(inclusive_world2, SystemMove_ID))] == 3);
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world2,
-                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase1_ID))] == 1);
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world2,
-                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase2_ID))] == 1);
-    test_true(inclusive_world->byA.num_A_ids[tnecs_A_id(inclusive_world2,
-                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase4_ID))] == 0);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world2,
+                                                            TNECS_S_ID2A(inclusive_world2, SystemMove_ID))].num_A_ids == 3);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world2,
+                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase1_ID))].num_A_ids == 1);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world2,
+                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase2_ID))].num_A_ids == 1);
+    test_true(inclusive_world->byA.arr[tnecs_A_id(inclusive_world2,
+                                                            TNECS_S_ID2A(inclusive_world2, SystemMovePhase4_ID))].num_A_ids == 0);
 
     test_true(inclusive_world2->byA.num == 8);
     TNECS_E_CREATE_wC(inclusive_world2, Unit_ID);
@@ -1094,21 +1078,19 @@ void tnecs_test_grow() {
         test_true(grow_world->Es.id[i] == 0);
     }
 
+    /* Empty slots: allocated on first use */
     for (size_t i = 0; i < grow_world->byA.len; i++) {
-        test_true(grow_world->byA.num_Es[i] == 0);
-        test_true(grow_world->byA.len_Es[i] == TNECS_E_0LEN);
-        for (size_t j = 0; j < grow_world->byA.len_Es[i]; j++) {
-            test_true(grow_world->byA.Es[i][j] == 0);
-        }
-        test_true(grow_world->byA.num_Cs[i] == 0);
+        test_true(grow_world->byA.arr[i].num_Es == 0);
+        test_true(grow_world->byA.arr[i].len_Es == 0);
+        test_true(grow_world->byA.arr[i].Es     == NULL);
+        test_true(grow_world->byA.arr[i].subA   == NULL);
+        test_true(grow_world->byA.arr[i].num_Cs == 0);
     }
 
     for (size_t i = 0; i < grow_world->Pis.byPh[0].len; i++) {
         test_true(grow_world->Pis.byPh[0].num_Ss[i] == 0);
-        test_true(grow_world->Pis.byPh[0].len_Ss[i] == TNECS_Ph_0LEN);
-        for (size_t j = 0; j < grow_world->Pis.byPh[0].len_Ss[i]; j++) {
-            test_true(grow_world->Pis.byPh[0].Ss[i][j] == 0);
-        }
+        test_true(grow_world->Pis.byPh[0].len_Ss[i] == 0);
+        test_true(grow_world->Pis.byPh[0].Ss[i]     == NULL);
     }
 
     tnecs_grow_E(grow_world);
@@ -1122,28 +1104,29 @@ void tnecs_test_grow() {
 
     size_t test_archetypeid = 0;
     tnecs_grow_byA(grow_world, test_archetypeid);
-    test_true(grow_world->byA.num_Es[test_archetypeid] == 0);
-    test_true(grow_world->byA.len_Es[test_archetypeid] == TNECS_E_0LEN *
+    test_true(grow_world->byA.arr[test_archetypeid].len_Es == TNECS_E_0LEN);
+    tnecs_grow_byA(grow_world, test_archetypeid);
+    test_true(grow_world->byA.arr[test_archetypeid].num_Es == 0);
+    test_true(grow_world->byA.arr[test_archetypeid].len_Es == TNECS_E_0LEN *
         TNECS_ARR_GROW);
-    for (size_t j = 0; j < grow_world->byA.len_Es[test_archetypeid]; j++) {
-        test_true(grow_world->byA.Es[test_archetypeid][j] == 0);
+    for (size_t j = 0; j < grow_world->byA.arr[test_archetypeid].len_Es; j++) {
+        test_true(grow_world->byA.arr[test_archetypeid].Es[j] == 0);
     }
 
     test_archetypeid = 1;
     tnecs_grow_byA(grow_world, test_archetypeid);
-    test_true(grow_world->byA.num_Es[test_archetypeid] == 0);
-    test_true(grow_world->byA.len_Es[test_archetypeid] == TNECS_E_0LEN *
+    tnecs_grow_byA(grow_world, test_archetypeid);
+    test_true(grow_world->byA.arr[test_archetypeid].num_Es == 0);
+    test_true(grow_world->byA.arr[test_archetypeid].len_Es == TNECS_E_0LEN *
         TNECS_ARR_GROW);
-    for (size_t j = 0; j < grow_world->byA.len_Es[test_archetypeid]; j++) {
-        test_true(grow_world->byA.Es[test_archetypeid][j] == 0);
+    for (size_t j = 0; j < grow_world->byA.arr[test_archetypeid].len_Es; j++) {
+        test_true(grow_world->byA.arr[test_archetypeid].Es[j] == 0);
     }
     for (size_t i = (test_archetypeid + 1); i < grow_world->byA.len; i++) {
-        test_true(grow_world->byA.num_Es[i] == 0);
-        test_true(grow_world->byA.len_Es[i] == TNECS_E_0LEN);
-        for (size_t j = 0; j < grow_world->byA.len_Es[i]; j++) {
-            test_true(grow_world->byA.Es[i][j] == 0);
-        }
-        test_true(grow_world->byA.num_Cs[i] == 0);
+        test_true(grow_world->byA.arr[i].num_Es == 0);
+        test_true(grow_world->byA.arr[i].len_Es == 0);
+        test_true(grow_world->byA.arr[i].Es     == NULL);
+        test_true(grow_world->byA.arr[i].num_Cs == 0);
     }
 
     tnecs_grow_S(grow_world);
@@ -1154,12 +1137,10 @@ void tnecs_test_grow() {
     test_true(grow_world->byA.num == 1);
 
     for (size_t i = TNECS_S_0LEN; i < grow_world->byA.len; i++) {
-        test_true(grow_world->byA.num_Es[i] == 0);
-        test_true(grow_world->byA.len_Es[i] == TNECS_E_0LEN);
-        for (size_t j = 0; j < grow_world->byA.len_Es[i]; j++) {
-            test_true(grow_world->byA.Es[i][j] == 0);
-        }
-        test_true(grow_world->byA.num_Cs[i] == 0);
+        test_true(grow_world->byA.arr[i].num_Es == 0);
+        test_true(grow_world->byA.arr[i].len_Es == 0);
+        test_true(grow_world->byA.arr[i].Es     == NULL);
+        test_true(grow_world->byA.arr[i].num_Cs == 0);
     }
 
     tnecs_grow_Ph(grow_world, 0);
@@ -1168,128 +1149,28 @@ void tnecs_test_grow() {
     test_true(grow_world->Pis.byPh[0].num == 1);
     for (size_t i = TNECS_Ph_0LEN; i < grow_world->Pis.byPh[0].len; i++) {
         test_true(grow_world->Pis.byPh[0].num_Ss[i] == 0);
-        test_true(grow_world->Pis.byPh[0].len_Ss[i] == TNECS_Ph_0LEN);
-        for (size_t j = 0; j < grow_world->Pis.byPh[0].len_Ss[i]; j++) {
-            test_true(grow_world->Pis.byPh[0].Ss[i][j] == 0);
-        }
+        test_true(grow_world->Pis.byPh[0].len_Ss[i] == 0);
+        test_true(grow_world->Pis.byPh[0].Ss[i]     == NULL);
     }
 
-    tnecs_finale(&grow_world);
-}
-
-void tnecs_benchmarks(uint64_t num) {
-    // printf("tnecs_benchmarks \n");
-    u64 t_0;
-    u64 t_1;
-
-    uint32_t rand1 = rand() % 100;
-    uint32_t rand2 = rand() % 100;
-
-    dupprintf(globalf, " %8llu\t", num);
-    t_0 = tnecs_get_us();
-    tnecs_W *bench_world = NULL;
-    tnecs_genesis(&bench_world);
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    TNECS_REGISTER_C(bench_world, Position2, NULL, NULL);
-    TNECS_REGISTER_C(bench_world, Unit2, NULL, NULL);
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    int Position2_ID    = 1;
-    int Unit2_ID        = 2;
-    for (uint64_t i = 0; i < num; i++) {
-        TNECS_E_CREATE_wC(bench_world, Position2_ID, Unit2_ID);
+    /* More subarchetypes than TNECS_C_CAP */
+    for (size_t C_id = 1; C_id <= 8; C_id++) {
+        TNECS_REGISTER_C(grow_world, Unit, NULL, NULL);
     }
-
-    t_0 = tnecs_get_us();
-    TNECS_REGISTER_S(bench_world, SystemMove2, pipe0, 0, 0, Position2_ID, Unit2_ID);
-    t_1 = tnecs_get_us();
-
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        test_Es[i] = tnecs_E_create(bench_world);
+    tnecs_C base = TNECS_C_ID2T(1);
+    for (tnecs_C A = 0; A < 128; A++) {
+        tnecs_E E = tnecs_E_create(grow_world);
+        test_true(tnecs_E_add_C(grow_world, E, base | (A << 1), 1));
     }
-
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        tnecs_E ent = test_Es[i] * (rand2 + 1) % num;
-        tnecs_E_destroy(bench_world, ent);
+    size_t base_id = tnecs_A_id(grow_world, base);
+    test_true(grow_world->byA.arr[base_id].num_A_ids == 127);
+    test_true(grow_world->byA.arr[base_id].len_A_ids >= 127);
+    for (size_t i = 1; i < 127; i++) {
+        test_true(grow_world->byA.arr[base_id].subA[i - 1] <
+                  grow_world->byA.arr[base_id].subA[i]);
     }
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        // TODO: benchmark reuse or not
-        test_Es[i] = tnecs_E_create(bench_world);
-    }
-
-    t_0 = tnecs_get_us();
-    TNECS_ADD_C(bench_world, test_Es[1], Position2_ID);
-    TNECS_ADD_C(bench_world, test_Es[1], Unit2_ID);
-    for (size_t i = 2; i < ITERATIONS; i++) {
-        tnecs_E ent = test_Es[i] * (rand1 + 2) % num;
-        TNECS_ADD_C(bench_world, ent, Position2_ID, false);
-        TNECS_ADD_C(bench_world, ent, Unit2_ID, false);
-    }
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        TNECS_E_CREATE_wC(bench_world, Position2_ID);
-    }
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    tnecs_E tnecs_Es2[ITERATIONS];
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        TNECS_E_CREATE_wC(bench_world, Position2_ID);
-        tnecs_Es2[i] = TNECS_E_CREATE_wC(bench_world, Position2_ID, Unit2_ID);
-        assert(bench_world->Es.id[tnecs_Es2[i]] == tnecs_Es2[i]);
-    }
-
-
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
 
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        // TODO: destroy random entity
-        assert(bench_world->Es.id[tnecs_Es2[i]] == tnecs_Es2[i]);
-        tnecs_E_destroy(bench_world, tnecs_Es2[i]);
-    }
-
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < ITERATIONS; i++) {
-        tnecs_E ent = test_Es[i] * (rand2 + 5) % num;
-        struct Position2    *pos   = tnecs_get_C(bench_world, ent, Position2_ID);
-        struct Unit2        *unit  = tnecs_get_C(bench_world, ent, Unit2_ID);
-        if (pos && unit) {
-            unit->hp = pos->x + pos->y;
-        }
-    }
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    for (size_t i = 0; i < fps_iterations; i++) {
-        tnecs_step(bench_world, 1, NULL);
-    }
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\t", t_1 - t_0);
-
-    t_0 = tnecs_get_us();
-    tnecs_finale(&bench_world);
-    t_1 = tnecs_get_us();
-    dupprintf(globalf, "%7llu\n", t_1 - t_0);
+    tnecs_finale(&grow_world);
 }
 
 void test_log2() {
@@ -1388,6 +1269,1572 @@ void tnecs_test_Pis() {
     tnecs_finale(&pipe_world);
 }
 
+size_t plan_calls = 0;
+void SystemPlanCount(struct tnecs_In *input) {
+    plan_calls++;
+}
+
+void SystemPlanMutate(struct tnecs_In *input) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+    /* Structural change while stepping: new archetype */
+    if (tnecs_A_id(input->world, TNECS_C_IDS2A(Position_ID, Velocity_ID, Unit_ID)) == 0)
+        TNECS_E_CREATE_wC(input->world, Position_ID, Velocity_ID, Unit_ID);
+}
+
+size_t columns_checked = 0;
+void SystemPlanColumns(struct tnecs_In *input) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    /* Pre-resolved columns match looked up columns */
+    test_true(TNECS_In_C(input, 0) == TNECS_C_ARRAY(input, Position_ID));
+    test_true(TNECS_In_C(input, 1) == TNECS_C_ARRAY(input, Velocity_ID));
+    test_true(input->Es == input->world->byA.arr[input->E_A_id].Es);
+    for (size_t i = 0; i < input->num_Es; i++) {
+        test_true(input->world->Es.Os[input->Es[i]] == i);
+        columns_checked++;
+    }
+}
+
+void tnecs_test_plan(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *plan_world = NULL;
+    tnecs_genesis(&plan_world);
+    test_true(plan_world->plan.dirty);
+    test_true(plan_world->plan.num == 0);
+
+    TNECS_REGISTER_C(plan_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(plan_world, Velocity, NULL, NULL);
+    TNECS_REGISTER_C(plan_world, Unit, NULL, NULL);
+    size_t S_mut    = TNECS_REGISTER_S(plan_world, SystemPlanMutate, pipe0, 0, 1, Unit_ID);
+    size_t S_count  = TNECS_REGISTER_S(plan_world, SystemPlanCount,  pipe0, 0, 0, Position_ID);
+
+    TNECS_E_CREATE_wC(plan_world, Unit_ID);
+    TNECS_E_CREATE_wC(plan_world, Position_ID);
+    TNECS_E_CREATE_wC(plan_world, Position_ID, Velocity_ID);
+
+    /* Plan: SystemPlanMutate x1, SystemPlanCount x2 */
+    tnecs_step(plan_world, 1, NULL);
+    test_true(plan_world->Ss.plan_O[S_mut]      == 0);
+    test_true(plan_world->Ss.plan_num[S_mut]    == 1);
+    test_true(plan_world->Ss.plan_O[S_count]    == 1);
+
+    /* SystemPlanMutate registered a new archetype mid-step:
+    **  SystemPlanCount ran on it in the same step. */
+    test_true(!plan_world->plan.dirty);
+    test_true(plan_world->Ss.plan_num[S_count]  == 3);
+    test_true(plan_world->plan.num              == 4);
+    test_true(plan_calls                        == 3);
+    test_true(plan_world->plan.Ss[0]            == SystemPlanMutate);
+    test_true(plan_world->plan.tables[1].A_id          == tnecs_A_id(plan_world, TNECS_C_IDS2A(Position_ID)));
+
+    /* Entity creation is not structural, plan is kept */
+    TNECS_E_CREATE_wC(plan_world, Position_ID);
+    test_true(!plan_world->plan.dirty);
+    tnecs_step(plan_world, 1, NULL);
+    test_true(plan_calls == 6);
+
+    /* New archetypes are */
+    TNECS_E_CREATE_wC(plan_world, Position_ID, Unit_ID);
+    test_true(plan_world->plan.dirty);
+    tnecs_S_run(plan_world, S_count, 1, NULL);
+    test_true(plan_world->Ss.plan_num[S_count] == 4);
+    test_true(plan_calls == 10);
+
+    /* Growing columns only re-resolves column pointers */
+    TNECS_REGISTER_S(plan_world, SystemPlanColumns, pipe0, 0, 0, Position_ID, Velocity_ID);
+    tnecs_step(plan_world, 1, NULL);
+    test_true(!plan_world->plan.stale);
+    for (size_t i = 0; i < 100; i++) {
+        TNECS_E_CREATE_wC(plan_world, Position_ID, Velocity_ID);
+    }
+    test_true(plan_world->plan.stale);
+    test_true(!plan_world->plan.dirty);
+    columns_checked = 0;
+    tnecs_step(plan_world, 1, NULL);
+    test_true(!plan_world->plan.stale);
+    test_true(columns_checked == 102);
+
+    tnecs_finale(&plan_world);
+}
+
+size_t batch_calls     = 0;
+size_t batch_tables    = 0;
+size_t batch_Es        = 0;
+void SystemBatch(struct tnecs_In *input) {
+    int Position_ID = 1;
+    batch_calls++;
+    batch_tables = input->num_tables;
+    size_t total = 0;
+    for (size_t t = 0; t < input->num_tables; t++) {
+        tnecs_Table *table = &input->tables[t];
+        struct Position *p = table->Cs[0];
+        test_true(p == tnecs_C_array(input->world, Position_ID, table->A_id));
+        test_true(table->num_Es == input->world->byA.arr[table->A_id].num_Es);
+        for (size_t i = 0; i < table->num_Es; i++) {
+            p[i].x++;
+        }
+        total += table->num_Es;
+    }
+    test_true(total == input->num_Es);
+    batch_Es = total;
+}
+
+void tnecs_test_S_batch(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *batch_world = NULL;
+    tnecs_genesis(&batch_world);
+    TNECS_REGISTER_C(batch_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(batch_world, Velocity, NULL, NULL);
+    TNECS_REGISTER_C(batch_world, Unit, NULL, NULL);
+    size_t S_id = TNECS_REGISTER_S_BATCH(batch_world, SystemBatch, pipe0, 0, Position_ID);
+    test_true(batch_world->Ss.batch[S_id]);
+    test_true(!batch_world->Ss.Ex[S_id]);
+
+    tnecs_E E1 = TNECS_E_CREATE_wC(batch_world, Position_ID);
+    tnecs_E E2 = TNECS_E_CREATE_wC(batch_world, Position_ID, Velocity_ID);
+    tnecs_E E3 = TNECS_E_CREATE_wC(batch_world, Position_ID, Unit_ID);
+    TNECS_E_CREATE_wC(batch_world, Position_ID, Unit_ID);
+    TNECS_E_CREATE_wC(batch_world, Velocity_ID);
+
+    /* One call, with all 3 archetypes with Position */
+    tnecs_step(batch_world, 1, NULL);
+    test_true(batch_calls   == 1);
+    test_true(batch_tables  == 3);
+    test_true(batch_Es      == 4);
+    test_true(batch_world->Ss.to_run.num    == 1);
+    test_true(batch_world->Ss.ran.num       == 1);
+
+    tnecs_S_run(batch_world, S_id, 1, NULL);
+    test_true(batch_calls == 2);
+    struct Position *pos = tnecs_get_C(batch_world, E1, Position_ID);
+    test_true(pos->x == 2);
+    pos = tnecs_get_C(batch_world, E2, Position_ID);
+    test_true(pos->x == 2);
+    pos = tnecs_get_C(batch_world, E3, Position_ID);
+    test_true(pos->x == 2);
+
+    tnecs_finale(&batch_world);
+}
+
+#ifdef TNECS_PROFILE
+void tnecs_test_profile(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *prof_world = NULL;
+    tnecs_genesis(&prof_world);
+    TNECS_REGISTER_C(prof_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(prof_world, Velocity, NULL, NULL);
+    TNECS_REGISTER_C(prof_world, Unit, NULL, NULL);
+    size_t S_id = TNECS_REGISTER_S(prof_world, SystemPlanCount, pipe0, 0, 0, Position_ID);
+    tnecs_E prof_Es[3];
+    prof_Es[0] = TNECS_E_CREATE_wC(prof_world, Position_ID);
+    prof_Es[1] = TNECS_E_CREATE_wC(prof_world, Position_ID);
+    prof_Es[2] = TNECS_E_CREATE_wC(prof_world, Position_ID, Velocity_ID);
+    /* Empty archetype: not called, not counted */
+    tnecs_E_destroy(prof_world, TNECS_E_CREATE_wC(prof_world, Position_ID, Unit_ID));
+
+    const tnecs_S_prof *prof = tnecs_S_profile(prof_world, S_id);
+    test_true(prof != NULL);
+    test_true(prof->runs == 0);
+
+    for (int i = 0; i < 3; i++) {
+        tnecs_step(prof_world, 1, NULL);
+    }
+    test_true(prof->runs    == 3);
+    test_true(prof->calls   == 6);
+    test_true(prof->num_As  == 6);
+    test_true(prof->num_Es  == 9);
+    test_true(prof->min     <= prof->max);
+    test_true(prof->max     <= prof->total);
+
+    /* No Es: no run, min kept */
+    tnecs_ns min = prof->min;
+    for (int i = 0; i < 3; i++)
+        tnecs_E_destroy(prof_world, prof_Es[i]);
+    tnecs_step(prof_world, 1, NULL);
+    test_true(prof->runs    == 3);
+    test_true(prof->calls   == 6);
+    test_true(prof->num_As  == 6);
+    test_true(prof->min     == min);
+
+    tnecs_profile_reset(prof_world);
+    test_true(prof->runs    == 0);
+    test_true(prof->total   == 0);
+    test_true(tnecs_S_profile(prof_world, S_id + 1) == NULL);
+
+    tnecs_finale(&prof_world);
+}
+#endif /* TNECS_PROFILE */
+
+#ifdef TNECS_TRACE
+void tnecs_test_trace(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+
+    tnecs_W *trace_world = NULL;
+    tnecs_genesis(&trace_world);
+    test_true(trace_world->trace.len == TNECS_TRACE_LEN);
+    TNECS_REGISTER_C(trace_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(trace_world, Velocity, NULL, NULL);
+    tnecs_register_Ph(trace_world, pipe0);
+    TNECS_REGISTER_S(trace_world, SystemPlanCount, pipe0, 0, 0, Position_ID);
+    TNECS_REGISTER_S(trace_world, SystemPlanCount, pipe0, 1, 0, Velocity_ID);
+    TNECS_E_CREATE_wC(trace_world, Position_ID, Velocity_ID);
+
+    /* Registering archetypes */
+    tnecs_Ev *evs = trace_world->trace.evs;
+    test_true(evs[0].kind == TNECS_TRACE_REGISTER_A);
+    test_true(evs[0].ph   == 'B');
+    test_true(evs[1].kind == TNECS_TRACE_REGISTER_A);
+    test_true(evs[1].ph   == 'E');
+
+    /* step, pipeline, 2x phase, 2x system */
+    tnecs_trace_clear(trace_world);
+    tnecs_step(trace_world, 1, NULL);
+    test_true(trace_world->trace.num == 12);
+    test_true(evs[0].kind   == TNECS_TRACE_STEP);
+    test_true(evs[1].kind   == TNECS_TRACE_Pi);
+    test_true(evs[2].kind   == TNECS_TRACE_Ph);
+    test_true(evs[2].id     == 0);
+    test_true(evs[3].kind   == TNECS_TRACE_S);
+    test_true(evs[3].ph     == 'B');
+    test_true(evs[4].kind   == TNECS_TRACE_S);
+    test_true(evs[4].ph     == 'E');
+    test_true(evs[5].kind   == TNECS_TRACE_Ph);
+    test_true(evs[5].ph     == 'E');
+    test_true(evs[6].kind   == TNECS_TRACE_Ph);
+    test_true(evs[6].id     == 1);
+    test_true(evs[11].kind  == TNECS_TRACE_STEP);
+    test_true(evs[11].ph    == 'E');
+    test_true(evs[0].ts     <= evs[11].ts);
+
+    /* Ring buffer: only latest events kept */
+    size_t steps = (2 * TNECS_TRACE_LEN) / 12 + 1;
+    for (size_t i = 0; i < steps; i++) {
+        tnecs_step(trace_world, 1, NULL);
+    }
+    test_true(trace_world->trace.num == (12 * (steps + 1)));
+    FILE *f = tmpfile();
+    test_true(tnecs_trace_dump(trace_world, f));
+    rewind(f);
+    char line[256];
+    size_t lines = 0, num_B = 0, num_E = 0;
+    test_true(fgets(line, sizeof(line), f) != NULL);
+    test_true(strcmp(line, "{\"traceEvents\":[\n") == 0);
+    while (fgets(line, sizeof(line), f) != NULL) {
+        num_B += (strstr(line, "\"ph\":\"B\"") != NULL);
+        num_E += (strstr(line, "\"ph\":\"E\"") != NULL);
+        lines++;
+    }
+    /* Window starts in a step: ends without begins dropped */
+    test_true(lines <= (TNECS_TRACE_LEN + 1));
+    test_true((lines + 12) > (TNECS_TRACE_LEN + 1));
+    test_true(num_B == num_E);
+    fclose(f);
+
+    tnecs_finale(&trace_world);
+}
+#endif /* TNECS_TRACE */
+
+void tnecs_test_stats(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+
+    tnecs_W *stat_world = NULL;
+    tnecs_genesis(&stat_world);
+    TNECS_REGISTER_C(stat_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(stat_world, Velocity, NULL, NULL);
+
+    tnecs_Stats stats;
+    test_true(tnecs_W_stats(stat_world, &stats));
+    test_true(stats.counts.migrations   == 0);
+    test_true(stats.counts.reallocs     == 0);
+    test_true(stats.counts.bytes_copied == 0);
+    test_true(stats.bytes_W  == sizeof(tnecs_W));
+    test_true(stats.bytes_Es > 0);
+    test_true(stats.total    > stats.bytes_As);
+
+    tnecs_E Silou   = TNECS_E_CREATE_wC(stat_world, Position_ID);
+    TNECS_E_CREATE_wC(stat_world, Position_ID);
+    TNECS_E_CREATE_wC(stat_world, Position_ID, Velocity_ID);
+
+    /* Per archetype */
+    tnecs_A_Stats A_stats;
+    size_t A_id = tnecs_A_id(stat_world, TNECS_C_ID2T(Position_ID));
+    test_true(tnecs_A_stats(stat_world, A_id, &A_stats));
+    test_true(A_stats.A         == TNECS_C_ID2T(Position_ID));
+    test_true(A_stats.num_Es    == 2);
+    test_true(A_stats.num_Cs    == 1);
+    test_true(A_stats.bytes_C[0] == (stat_world->byA.arr[A_id].Cs[0].len *
+                                     sizeof(Position)));
+    test_true(A_stats.bytes_Cs  == A_stats.bytes_C[0]);
+    test_true(A_stats.slack     == ((A_stats.len_Es - 2) * sizeof(tnecs_E) +
+                                    A_stats.bytes_C[0] - 2 * sizeof(Position)));
+    test_true(A_stats.meta      > 0);
+    test_true(!tnecs_A_stats(stat_world, stat_world->byA.num, &A_stats));
+
+    /* Migration copies one Position, scrambles one Position & E */
+    TNECS_ADD_C(stat_world, Silou, Velocity_ID);
+    test_true(tnecs_W_stats(stat_world, &stats));
+    test_true(stats.counts.migrations   == 1);
+    test_true(stats.counts.bytes_copied == (2 * sizeof(Position) +
+                                            sizeof(tnecs_E)));
+
+    /* Growth */
+    size_t total = stats.total;
+    for (int i = 0; i < 200; i++) {
+        TNECS_E_CREATE_wC(stat_world, Position_ID);
+    }
+    test_true(tnecs_W_stats(stat_world, &stats));
+    test_true(stats.counts.reallocs     > 0);
+    test_true(stats.counts.bytes_copied > (200 * sizeof(Position)));
+    test_true(stats.total               > total);
+    test_true(stats.total               > (stats.bytes_Cs + stats.meta));
+
+    tnecs_finale(&stat_world);
+}
+
+#ifdef TNECS_RECORD
+u64 test_rec_u(FILE *f) {
+    u64 u = 0;
+    int byte, shift = 0;
+    do {
+        byte = fgetc(f);
+        u |= (u64)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return (u);
+}
+
+int test_rec_replay(FILE *f, tnecs_W *W) {
+    /* Structural ops only: recorded Es must be replayed Es */
+    char magic[sizeof(TNECS_REC_MAGIC)] = {0};
+    if ((fread(magic, 1, strlen(TNECS_REC_MAGIC), f) != 8) ||
+        (test_rec_u(f) != TNECS_REC_VERSION))
+        return (0);
+    int op;
+    while ((op = fgetc(f)) != EOF) {
+        int num_args = fgetc(f);
+        u64 a[5] = {0};
+        for (int i = 0; (i < num_args) && (i < 5); i++)
+            a[i] = test_rec_u(f);
+        switch (op) {
+            case TNECS_REC_CREATE:
+                if (tnecs_E_create(W) != a[0])
+                    return (0);
+                break;
+            case TNECS_REC_DESTROY:
+                tnecs_E_destroy(W, a[0]);
+                break;
+            case TNECS_REC_ADD_C:
+                tnecs_E_add_C(W, a[0], a[1], (int)a[2]);
+                break;
+            case TNECS_REC_RM_C:
+                tnecs_E_rm_C(W, a[0], a[1]);
+                break;
+            case TNECS_REC_REGISTER_C:
+                tnecs_register_C(W, a[0], NULL, NULL);
+                break;
+            case TNECS_REC_REUSE_E:
+                tnecs_W_reuse_E(W, (int)a[0]);
+                break;
+            case TNECS_REC_GEN_E:
+                tnecs_W_gen_E(W, (int)a[0]);
+                break;
+        }
+    }
+    return (1);
+}
+
+void tnecs_test_record(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+
+    tnecs_W *rec_world = NULL;
+    tnecs_genesis(&rec_world);
+    FILE *f = tmpfile();
+    test_true(tnecs_record_start(rec_world, f));
+    TNECS_REGISTER_C(rec_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(rec_world, Velocity, NULL, NULL);
+    TNECS_REGISTER_S(rec_world, SystemPlanCount, pipe0, 0, 0, Position_ID);
+    tnecs_E Silou = TNECS_E_CREATE_wC(rec_world, Position_ID);
+    TNECS_ADD_C(rec_world, Silou, Velocity_ID);
+    TNECS_RM_C(rec_world, Silou, Position_ID);
+    tnecs_step(rec_world, 3, NULL);
+    tnecs_E_destroy(rec_world, Silou);
+    tnecs_record_stop(rec_world);
+    /* Not recorded */
+    tnecs_step(rec_world, 3, NULL);
+
+    rewind(f);
+    char magic[sizeof(TNECS_REC_MAGIC)] = {0};
+    test_true(fread(magic, 1, strlen(TNECS_REC_MAGIC), f) == 8);
+    test_true(strcmp(magic, TNECS_REC_MAGIC) == 0);
+    test_true(test_rec_u(f) == TNECS_REC_VERSION);
+
+    /* op, num args, first arg */
+    u64 expected[][3] = {
+        {TNECS_REC_REGISTER_C,  1, sizeof(Position)},
+        {TNECS_REC_REGISTER_C,  1, sizeof(Velocity)},
+        {TNECS_REC_REGISTER_S,  5, pipe0},
+        {TNECS_REC_CREATE,      1, Silou},
+        {TNECS_REC_ADD_C,       3, Silou},
+        {TNECS_REC_ADD_C,       3, Silou},
+        {TNECS_REC_RM_C,        2, Silou},
+        {TNECS_REC_STEP,        1, 3},
+        {TNECS_REC_DESTROY,     1, Silou},
+    };
+    size_t num = sizeof(expected) / sizeof(*expected);
+    for (size_t i = 0; i < num; i++) {
+        test_true(fgetc(f) == expected[i][0]);
+        u64 num_args = fgetc(f);
+        test_true(num_args == expected[i][1]);
+        test_true(test_rec_u(f) == expected[i][2]);
+        for (size_t j = 1; j < num_args; j++) {
+            test_rec_u(f);
+        }
+    }
+    test_true(fgetc(f) == EOF);
+    fclose(f);
+
+    tnecs_finale(&rec_world);
+}
+#endif /* TNECS_RECORD */
+
+void tnecs_test_save(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *save_world = NULL;
+    tnecs_genesis(&save_world);
+    tnecs_W_reuse_E(save_world, 1);
+    tnecs_W_gen_E(save_world, 1);
+    TNECS_REGISTER_C(save_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(save_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_C(save_world, Unit,      NULL, NULL);
+
+    tnecs_E Es[300];
+    for (size_t i = 0; i < 300; i++) {
+        if (i % 3 == 0)
+            Es[i] = TNECS_E_CREATE_wC(save_world, Position_ID);
+        else if (i % 3 == 1)
+            Es[i] = TNECS_E_CREATE_wC(save_world, Position_ID, Velocity_ID);
+        else
+            Es[i] = TNECS_E_CREATE_wC(save_world, Unit_ID);
+        Position *pos = tnecs_get_C(save_world, Es[i], Position_ID);
+        if (pos != NULL) {
+            pos->x = i;
+            pos->y = 2 * i;
+        }
+        Unit *unit = tnecs_get_C(save_world, Es[i], Unit_ID);
+        if (unit != NULL)
+            unit->hp = i;
+    }
+    for (size_t i = 0; i < 300; i += 7)
+        tnecs_E_destroy(save_world, Es[i]);
+
+    FILE *f = tmpfile();
+    test_true(tnecs_W_save(save_world, f));
+    rewind(f);
+    tnecs_W *load_world = NULL;
+    test_true(tnecs_W_load(&load_world, f));
+    fclose(f);
+
+    test_true(load_world->Es.num        == save_world->Es.num);
+    test_true(load_world->Es.open.num   == save_world->Es.open.num);
+    test_true(load_world->byA.num       == save_world->byA.num);
+    test_true(load_world->Cs.num        == save_world->Cs.num);
+    test_true(load_world->reuse_Es      == 1);
+    test_true(load_world->gen_Es        == 1);
+    for (size_t i = 0; i < 300; i++) {
+        tnecs_E E = Es[i];
+        test_true(load_world->Es.id[E] == save_world->Es.id[E]);
+        test_true(load_world->Es.As[E] == save_world->Es.As[E]);
+        test_true(load_world->Es.Os[E] == save_world->Es.Os[E]);
+        if (i % 7 == 0)
+            continue;
+        Position *pos = tnecs_get_C(load_world, E, Position_ID);
+        Unit *unit    = tnecs_get_C(load_world, E, Unit_ID);
+        test_true((pos  == NULL) || ((pos->x == i) && (pos->y == 2 * i)));
+        test_true((unit == NULL) || (unit->hp == i));
+    }
+
+    /* Loaded world runs: systems, reused & new Es */
+    plan_calls = 0;
+    TNECS_REGISTER_S(load_world, SystemPlanCount, 0, 0, 0, Position_ID);
+    tnecs_step(load_world, 1, NULL);
+    test_true(plan_calls == 2);
+    tnecs_E reused = TNECS_E_CREATE_wC(load_world, Velocity_ID);
+    tnecs_E *open = save_world->Es.open.arr;
+    test_true(TNECS_E_IDX(load_world, reused) == open[save_world->Es.open.num - 1]);
+    test_true(TNECS_E_GEN(reused) == 1);
+    /* Generations saved: stale handle stays stale */
+    test_true(!TNECS_E_EXISTS(load_world, Es[TNECS_E_IDX(load_world, reused) - 1]));
+    test_true(tnecs_get_C(load_world, Es[TNECS_E_IDX(load_world, reused) - 1],
+                          Velocity_ID) == NULL);
+    test_true(tnecs_get_C(load_world, reused, Velocity_ID) != NULL);
+    size_t num_open = load_world->Es.open.num;
+    for (size_t i = 0; i < 300; i++)
+        TNECS_E_CREATE_wC(load_world, Unit_ID);
+    test_true(load_world->Es.open.num == 0);
+    test_true(load_world->Es.num == save_world->Es.num + 300 - num_open);
+
+    /* Snapshots anywhere in stream: after other data, back to back */
+    f = tmpfile();
+    test_true(fputs("header", f) >= 0);
+    test_true(tnecs_W_save(save_world, f));
+    test_true(tnecs_W_save(load_world, f));
+    test_true(fputs("footer", f) >= 0);
+    rewind(f);
+    char prefix[7] = {0};
+    test_true(fread(prefix, 1, 6, f) == 6);
+    test_true(strcmp(prefix, "header") == 0);
+    tnecs_W *first = NULL, *second = NULL;
+    test_true(tnecs_W_load(&first, f));
+    test_true(tnecs_W_load(&second, f));
+    test_true(fread(prefix, 1, 6, f) == 6);
+    test_true(strcmp(prefix, "footer") == 0);
+    fclose(f);
+    test_true(first->Es.num     == save_world->Es.num);
+    test_true(second->Es.num    == load_world->Es.num);
+    for (size_t E = 1; E < second->Es.num; E++) {
+        test_true(second->Es.id[E] == load_world->Es.id[E]);
+        test_true(second->Es.As[E] == load_world->Es.As[E]);
+    }
+    Position *first_pos = tnecs_get_C(first, Es[1], Position_ID);
+    test_true((first_pos != NULL) && (first_pos->x == 1));
+    tnecs_finale(&first);
+    tnecs_finale(&second);
+
+#ifdef TNECS_MMAP
+    /* Mapped snapshot: same world, columns in file */
+    f = fopen("tnecs_test_save.bin", "wb");
+    test_true(tnecs_W_save(save_world, f));
+    fclose(f);
+    tnecs_W *map_world = NULL;
+    test_true(tnecs_W_map(&map_world, "tnecs_test_save.bin"));
+    test_true(map_world->map.base != NULL);
+    test_true(map_world->Es.num     == save_world->Es.num);
+    test_true(map_world->byA.num    == save_world->byA.num);
+    size_t tID = tnecs_A_id(map_world, TNECS_C_IDS2A(Position_ID));
+    test_true(map_world->byA.arr[tID].num_Es == save_world->byA.arr[tID].num_Es);
+    for (size_t i = 1; i < 300; i++) {
+        if (i % 7 == 0)
+            continue;
+        tnecs_E E = Es[i];
+        test_true(map_world->Es.As[E] == save_world->Es.As[E]);
+        Position *pos = tnecs_get_C(map_world, E, Position_ID);
+        test_true((pos == NULL) || ((pos->x == i) && (pos->y == 2 * i)));
+    }
+
+    /* Copy-on-write: file unchanged */
+    Position *pos = tnecs_get_C(map_world, Es[1], Position_ID);
+    pos->x = 1000;
+    tnecs_W *check_world = NULL;
+    test_true(tnecs_W_map(&check_world, "tnecs_test_save.bin"));
+    pos = tnecs_get_C(check_world, Es[1], Position_ID);
+    test_true(pos->x == 1);
+    tnecs_finale(&check_world);
+
+    /* Growth copies mapped arrays to heap */
+    plan_calls = 0;
+    TNECS_REGISTER_S(map_world, SystemPlanCount, 0, 0, 0, Position_ID);
+    for (size_t i = 0; i < 300; i++)
+        TNECS_E_CREATE_wC(map_world, Position_ID);
+    test_true(!tnecs_mapped(map_world, map_world->byA.arr[tID].Es));
+    test_true(!tnecs_mapped(map_world, map_world->byA.arr[tID].Cs[0].Cs));
+    test_true(!TNECS_E_EXISTS(map_world, Es[0]));
+    test_true(TNECS_E_GEN(map_world->Es.id[TNECS_E_IDX(map_world, Es[0])]) == 1);
+    pos = tnecs_get_C(map_world, Es[1], Position_ID);
+    test_true(pos->x == 1000);
+    tnecs_E_destroy(map_world, Es[2]);
+    tnecs_step(map_world, 1, NULL);
+    test_true(plan_calls == 2);
+    tnecs_finale(&map_world);
+    remove("tnecs_test_save.bin");
+#endif /* TNECS_MMAP */
+
+    tnecs_finale(&save_world);
+    tnecs_finale(&load_world);
+}
+
+int test_W_copy(tnecs_W *W, tnecs_W **out) {
+    FILE *f = tmpfile();
+    int success = tnecs_W_save(W, f);
+    rewind(f);
+    success = success && tnecs_W_load(out, f);
+    fclose(f);
+    return (success);
+}
+
+size_t delta_inits = 0;
+void Delta_Init(void *C) {
+    delta_inits++;
+}
+
+void tnecs_test_delta(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *delta_world = NULL;
+    tnecs_genesis(&delta_world);
+    tnecs_W_reuse_E(delta_world, 1);
+    TNECS_REGISTER_C(delta_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(delta_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_C(delta_world, Unit,      NULL, NULL);
+    tnecs_E Es[200];
+    for (size_t i = 0; i < 200; i++) {
+        Es[i] = (i % 2) ? TNECS_E_CREATE_wC(delta_world, Position_ID) :
+                          TNECS_E_CREATE_wC(delta_world, Unit_ID, Velocity_ID);
+        Unit *unit = tnecs_get_C(delta_world, Es[i], Unit_ID);
+        if (unit != NULL)
+            unit->hp = i;
+    }
+    tnecs_W *base = NULL, *copy = NULL;
+    test_true(test_W_copy(delta_world, &base));
+    test_true(test_W_copy(delta_world, &copy));
+
+    /* No change: empty delta */
+    FILE *f = tmpfile();
+    test_true(tnecs_W_diff(base, delta_world, f));
+    long empty_len = ftell(f);
+    fclose(f);
+
+    /* Changes: values, archetypes, created, destroyed */
+    Position *pos = tnecs_get_C(delta_world, Es[1], Position_ID);
+    pos->x = 77;
+    Unit *unit = tnecs_get_C(delta_world, Es[2], Unit_ID);
+    unit->str = 5;
+    TNECS_ADD_C(delta_world, Es[3], Unit_ID);
+    unit = tnecs_get_C(delta_world, Es[3], Unit_ID);
+    unit->hp = 33;
+    TNECS_RM_C(delta_world, Es[4], Velocity_ID);
+    tnecs_E_destroy(delta_world, Es[5]);
+    tnecs_E_destroy(delta_world, Es[6]);
+    tnecs_E created = TNECS_E_CREATE_wC(delta_world, Position_ID, Velocity_ID);
+    test_true(created == Es[6]);
+    pos = tnecs_get_C(delta_world, created, Position_ID);
+    pos->y = 9;
+    tnecs_E added = TNECS_E_CREATE_wC(delta_world, Velocity_ID);
+    Velocity *vel = tnecs_get_C(delta_world, added, Velocity_ID);
+    vel->vw = 1234;
+
+    f = tmpfile();
+    test_true(tnecs_W_diff(base, delta_world, f));
+    test_true(ftell(f) > empty_len);
+    test_true(ftell(f) < 512);
+    rewind(f);
+    /* Added Cs come from delta: finit never runs */
+    copy->Cs.finit[Position_ID] = Delta_Init;
+    copy->Cs.finit[Unit_ID]     = Delta_Init;
+    test_true(tnecs_W_apply(copy, f));
+    test_true(delta_inits == 0);
+    fclose(f);
+
+    /* Applied copy matches world */
+    test_true(copy->Es.num      == delta_world->Es.num);
+    test_true(copy->Es.open.num == delta_world->Es.open.num);
+    for (tnecs_E E = 1; E < delta_world->Es.num; E++) {
+        test_true(TNECS_E_EXISTS(copy, E) == TNECS_E_EXISTS(delta_world, E));
+        if (!TNECS_E_EXISTS(delta_world, E))
+            continue;
+        test_true(copy->Es.As[E] == delta_world->Es.As[E]);
+        for (size_t C_id = 1; C_id < delta_world->Cs.num; C_id++) {
+            void *C_W = tnecs_get_C(delta_world, E, C_id);
+            void *C_copy = tnecs_get_C(copy, E, C_id);
+            test_true((C_W == NULL) == (C_copy == NULL));
+            if (C_W != NULL)
+                test_true(memcmp(C_W, C_copy, delta_world->Cs.bytesizes[C_id]) == 0);
+        }
+    }
+    tnecs_E next = TNECS_E_CREATE_wC(copy, Unit_ID);
+    test_true(next == TNECS_E_CREATE_wC(delta_world, Unit_ID));
+
+    tnecs_finale(&delta_world);
+    tnecs_finale(&base);
+    tnecs_finale(&copy);
+}
+
+void tnecs_test_clone(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    tnecs_W *clone_world = NULL;
+    tnecs_genesis(&clone_world);
+    TNECS_REGISTER_C(clone_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(clone_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_C(clone_world, Unit,      NULL, NULL);
+    TNECS_REGISTER_S(clone_world, SystemMove, 0, 0, 0, Position_ID, Velocity_ID);
+    tnecs_E Es[100];
+    for (size_t i = 0; i < 100; i++) {
+        Es[i] = (i % 2) ? TNECS_E_CREATE_wC(clone_world, Position_ID, Velocity_ID) :
+                          TNECS_E_CREATE_wC(clone_world, Unit_ID);
+        Velocity *vel = tnecs_get_C(clone_world, Es[i], Velocity_ID);
+        if (vel != NULL)
+            vel->vx = 1;
+    }
+    tnecs_step(clone_world, 1, NULL);
+
+    /* Deep clone: independent */
+    tnecs_W *clone = NULL;
+    test_true(tnecs_W_clone(clone_world, &clone));
+    test_true(clone->Es.num == clone_world->Es.num);
+    tnecs_step(clone, 1, NULL);
+    Position *pos = tnecs_get_C(clone, Es[1], Position_ID);
+    test_true(pos->x == 2);
+    pos = tnecs_get_C(clone_world, Es[1], Position_ID);
+    test_true(pos->x == 1);
+    tnecs_E_destroy(clone, Es[3]);
+    test_true(TNECS_E_EXISTS(clone_world, Es[3]));
+
+    /* COW clone: shares columns until written */
+    tnecs_W *cow = NULL;
+    test_true(tnecs_W_clone_cow(clone_world, &cow));
+    size_t tID = tnecs_A_id(cow, TNECS_C_IDS2A(Unit_ID));
+    test_true(cow->byA.arr[tID].Cs[0].Cs    == clone_world->byA.arr[tID].Cs[0].Cs);
+    test_true(*cow->byA.arr[tID].Cs[0].refs == 2);
+    Unit *unit = tnecs_get_C(cow, Es[0], Unit_ID);
+    unit->hp = 5;
+    test_true(cow->byA.arr[tID].Cs[0].Cs    != clone_world->byA.arr[tID].Cs[0].Cs);
+    unit = tnecs_get_C(clone_world, Es[0], Unit_ID);
+    test_true(unit->hp == 0);
+    test_true(clone_world->byA.arr[tID].Cs[0].refs == NULL);
+
+    /* Steps write system columns: copied on both sides */
+    tnecs_step(clone_world, 1, NULL);
+    tnecs_step(clone_world, 1, NULL);
+    pos = tnecs_get_C(cow, Es[1], Position_ID);
+    test_true(pos->x == 1);
+    tnecs_step(cow, 1, NULL);
+    test_true(pos->x == 2);
+    pos = tnecs_get_C(clone_world, Es[1], Position_ID);
+    test_true(pos->x == 3);
+    TNECS_E_CREATE_wC(cow, Unit_ID);
+    tnecs_finale(&cow);
+    tnecs_finale(&clone);
+
+    /* COW clone: growing or writing columns of source copies them */
+    tnecs_C A_move = TNECS_C_IDS2A(Position_ID, Velocity_ID);
+    tID = tnecs_A_id(clone_world, A_move);
+    size_t C_O  = clone_world->byA.arr[tID].Cs_O[Position_ID];
+    size_t E_O  = clone_world->Es.Os[Es[1]];
+    test_true(tnecs_W_clone_cow(clone_world, &cow));
+    Position *shared = cow->byA.arr[tID].Cs[C_O].Cs;
+    int cow_x = shared[E_O].x;
+    test_true(shared == clone_world->byA.arr[tID].Cs[C_O].Cs);
+    test_true(tnecs_W_reserve(clone_world, A_move,
+                              clone_world->byA.arr[tID].Cs[C_O].len));
+    test_true(cow->byA.arr[tID].Cs[C_O].refs != NULL);
+    test_true(shared != clone_world->byA.arr[tID].Cs[C_O].Cs);
+    test_true(shared[E_O].x == cow_x);
+    tnecs_finale(&cow);
+
+    test_true(tnecs_W_clone_cow(clone_world, &cow));
+    shared = cow->byA.arr[tID].Cs[C_O].Cs;
+    while (clone_world->byA.arr[tID].num_Es < 200)
+        TNECS_E_CREATE_wC(clone_world, Position_ID, Velocity_ID);
+    test_true(tnecs_W_clone_cow(clone_world, &clone));
+    test_true(tnecs_W_idle(clone_world, 0));
+    test_true(shared == cow->byA.arr[tID].Cs[C_O].Cs);
+    test_true(shared[E_O].x == cow_x);
+    test_true(clone->byA.arr[tID].Cs[C_O].refs != NULL);
+    test_true(clone->byA.arr[tID].Cs[C_O].Cs !=
+              clone_world->byA.arr[tID].Cs[C_O].Cs);
+    tnecs_finale(&clone);
+
+    Position *column = tnecs_C_array(clone_world, Position_ID, tID);
+    test_true(column != NULL);
+    test_true(column != shared);
+    column[E_O].x = 77;
+    test_true(shared[E_O].x == cow_x);
+    column[E_O].x = cow_x;
+    tnecs_finale(&cow);
+
+    /* Ring: rewind to earlier steps */
+    tnecs_Ring ring;
+    test_true(tnecs_ring_genesis(&ring, 4));
+    for (size_t i = 0; i < 6; i++) {
+        test_true(tnecs_ring_push(&ring, clone_world));
+        tnecs_step(clone_world, 1, NULL);
+    }
+    pos = tnecs_get_C(clone_world, Es[1], Position_ID);
+    test_true(pos->x == 9);
+    test_true(tnecs_ring_get(&ring, 4) == NULL);
+    pos = tnecs_get_C(tnecs_ring_get(&ring, 0), Es[1], Position_ID);
+    test_true(pos->x == 8);
+    test_true(tnecs_ring_rewind(&ring, 2, &clone_world));
+    pos = tnecs_get_C(clone_world, Es[1], Position_ID);
+    test_true(pos->x == 6);
+    test_true(ring.num == 4);
+    tnecs_step(clone_world, 1, NULL);
+    test_true(pos->x == 7);
+    test_true(tnecs_ring_finale(&ring));
+
+    tnecs_finale(&clone_world);
+}
+
+void tnecs_test_config(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+
+    /* Defaults */
+    tnecs_W *config_world = NULL;
+    test_true(tnecs_genesis_config(&config_world, NULL, NULL));
+    test_true(config_world->Es.len          == TNECS_E_0LEN);
+    test_true(config_world->byA.len         == TNECS_A_0LEN);
+    test_true(config_world->config.grow     == TNECS_ARR_GROW);
+    test_true(config_world->config.linear   == 0);
+    test_true(tnecs_grow_len(config_world, 100, 101) == 200);
+    test_true(tnecs_grow_len(config_world, 100, 401) == 800);
+
+    /* Columns as long as Es of archetype, 1.5x, linear above 512 */
+    tnecs_Config config = {0};
+    config.len_Es   = 1000;
+    config.len_byA  = 256;
+    config.len_C    = 256;
+    config.len_As   = 4;
+    config.grow     = 1.5;
+    config.linear   = 512;
+    test_true(tnecs_genesis_config(&config_world, &config, NULL));
+    test_true(config_world->Es.len      == 1000);
+    test_true(config_world->Es.open.len == 1000);
+    test_true(config_world->byA.len     == 4);
+    test_true(config_world->Ss.len      == TNECS_S_0LEN);
+    test_true(tnecs_grow_len(config_world, 100, 101)  == 150);
+    test_true(tnecs_grow_len(config_world, 400, 401)  == 600);
+    test_true(tnecs_grow_len(config_world, 600, 601)  == 1112);
+    test_true(tnecs_grow_len(config_world, 600, 2000) == 2136);
+
+    TNECS_REGISTER_C(config_world, Position, NULL, NULL);
+    TNECS_REGISTER_C(config_world, Velocity, NULL, NULL);
+    TNECS_E_CREATE_wC(config_world, Position_ID, Velocity_ID);
+    size_t tID = tnecs_A_id(config_world,
+                            TNECS_C_IDS2A(Position_ID, Velocity_ID));
+    test_true(config_world->byA.arr[tID].len_Es     == 256);
+    test_true(config_world->byA.arr[tID].Cs[0].len  == 256);
+
+    /* Es & both columns grow once */
+    size_t reallocs = config_world->counts.reallocs;
+    for (size_t i = 0; i < 300; i++)
+        TNECS_E_CREATE_wC(config_world, Position_ID, Velocity_ID);
+    test_true(config_world->byA.arr[tID].len_Es     == 384);
+    test_true(config_world->byA.arr[tID].Cs[1].len  == 384);
+    test_true(config_world->counts.reallocs == reallocs + 3);
+
+    for (size_t i = 0; i < 1000; i++)
+        tnecs_E_create(config_world);
+    test_true(config_world->Es.len == 1512);
+
+    /* Shrinking growth */
+    config.grow = 0.5;
+    test_true(!tnecs_genesis_config(&config_world, &config, NULL));
+    test_true(config_world == NULL);
+}
+
+/* Tracking allocator: size in header, checked on free */
+typedef struct Track {
+    size_t live;    /* bytes */
+    size_t allocs;
+    size_t reallocs;
+    size_t bad_frees;
+} Track;
+
+void *track_alloc(void *ctx, size_t bytes) {
+    Track *track = ctx;
+    size_t *out = calloc(1, bytes + sizeof(size_t));
+    *out = bytes;
+    track->live += bytes;
+    track->allocs++;
+    return (out + 1);
+}
+
+void track_free(void *ctx, void *ptr, size_t bytes) {
+    Track *track = ctx;
+    size_t *head = (size_t *)ptr - 1;
+    if (*head != bytes)
+        track->bad_frees++;
+    track->live -= *head;
+    free(head);
+}
+
+void *track_realloc(void *ctx, void *ptr, size_t obytes, size_t nbytes) {
+    Track *track = ctx;
+    size_t *head = (size_t *)ptr - 1;
+    if (*head != obytes)
+        track->bad_frees++;
+    head = realloc(head, nbytes + sizeof(size_t));
+    *head = nbytes;
+    track->live += nbytes - obytes;
+    track->reallocs++;
+    return (head + 1);
+}
+
+void tnecs_test_alloc(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    Track track = {0};
+    tnecs_Alloc alloc = {track_alloc, NULL, track_free, &track};
+    for (int hook = 0; hook < 2; hook++) {
+        /* Second pass: allocator realloc */
+        alloc.realloc = hook ? track_realloc : NULL;
+        tnecs_W *alloc_world = NULL;
+        test_true(tnecs_genesis_alloc(&alloc_world, &alloc));
+        test_true(track.live > 0);
+        TNECS_REGISTER_C(alloc_world, Position,  NULL, NULL);
+        TNECS_REGISTER_C(alloc_world, Velocity,  NULL, NULL);
+        TNECS_REGISTER_C(alloc_world, Unit,      NULL, NULL);
+        TNECS_REGISTER_S(alloc_world, SystemMove, 0, 0, 0, Position_ID, Velocity_ID);
+        tnecs_E Es[1000];
+        for (size_t i = 0; i < 1000; i++) {
+            Es[i] = TNECS_E_CREATE_wC(alloc_world, Position_ID, Velocity_ID);
+            if (i % 3 == 0)
+                TNECS_ADD_C(alloc_world, Es[i], Unit_ID);
+            if (i % 5 == 0)
+                TNECS_RM_C(alloc_world, Es[i], Velocity_ID);
+        }
+        for (size_t i = 0; i < 1000; i += 7)
+            tnecs_E_destroy(alloc_world, Es[i]);
+        tnecs_step(alloc_world, 1, NULL);
+
+        tnecs_W *clone = NULL;
+        tnecs_W *cow   = NULL;
+        test_true(tnecs_W_clone(alloc_world, &clone));
+        test_true(tnecs_W_clone_cow(alloc_world, &cow));
+        test_true(clone->alloc.ctx == &track);
+        tnecs_step(cow, 1, NULL);
+        tnecs_finale(&cow);
+        tnecs_finale(&clone);
+
+        /* Loaded & mapped worlds: allocator & config too */
+        tnecs_Config config = {0};
+        config.grow = 1.5;
+        FILE *f = fopen("tnecs_test_alloc.bin", "w+b");
+        test_true(tnecs_W_save(alloc_world, f));
+        rewind(f);
+        tnecs_W *loaded = NULL;
+        test_true(tnecs_W_load_config(&loaded, f, &config, &alloc));
+        fclose(f);
+        test_true(loaded->alloc.ctx     == &track);
+        test_true(loaded->config.grow   == 1.5);
+        size_t allocs = track.allocs;
+        for (size_t i = 0; i < 1000; i++)
+            TNECS_E_CREATE_wC(loaded, Position_ID, Unit_ID);
+        test_true(track.allocs > allocs);
+#ifdef TNECS_MMAP
+        tnecs_W *mapped = NULL;
+        test_true(tnecs_W_map_config(&mapped, "tnecs_test_alloc.bin",
+                                     &config, &alloc));
+        test_true(mapped->alloc.ctx     == &track);
+        test_true(mapped->config.grow   == 1.5);
+        allocs = track.allocs;
+        for (size_t i = 0; i < 1000; i++)
+            TNECS_E_CREATE_wC(mapped, Position_ID, Unit_ID);
+        test_true(track.allocs > allocs);
+        tnecs_finale(&mapped);
+#endif /* TNECS_MMAP */
+        remove("tnecs_test_alloc.bin");
+        tnecs_finale(&loaded);
+        tnecs_finale(&alloc_world);
+
+        /* Everything returned, with matching sizes */
+        test_true(track.live        == 0);
+        test_true(track.bad_frees   == 0);
+        test_true(track.reallocs    >  0 || !hook);
+    }
+    test_true(track.reallocs > 0);
+    test_true(track.allocs   > 0);
+}
+
+void tnecs_test_lock(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+    int Unit_ID     = 3;
+
+    Track track = {0};
+    tnecs_Alloc alloc = {track_alloc, NULL, track_free, &track};
+    tnecs_W *lock_world = NULL;
+    test_true(tnecs_genesis_alloc(&lock_world, &alloc));
+    TNECS_REGISTER_C(lock_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(lock_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_C(lock_world, Unit,      NULL, NULL);
+    TNECS_REGISTER_S(lock_world, SystemMove, 0, 0, 0, Position_ID, Velocity_ID);
+    tnecs_W_reuse_E(lock_world, 1);
+    tnecs_C A_PV    = TNECS_C_IDS2A(Position_ID, Velocity_ID);
+    tnecs_C A_P     = TNECS_C_IDS2A(Position_ID);
+    test_true(tnecs_W_reserve(lock_world, A_PV, 100));
+    test_true(tnecs_W_reserve(lock_world, A_P,  100));
+    test_true(tnecs_W_lock(lock_world, 1));
+    test_true(tnecs_W_reserve(lock_world, A_PV, 1) == 0);
+
+    /* Reserved: no allocation */
+    size_t allocs = track.allocs;
+    tnecs_E Es[100];
+    for (size_t i = 0; i < 100; i++) {
+        Es[i] = TNECS_E_CREATE_wC(lock_world, Position_ID, Velocity_ID);
+        test_true(Es[i] != TNECS_NULL);
+    }
+    tnecs_step(lock_world, 1, NULL);
+    test_true(TNECS_RM_C(lock_world, Es[0], Velocity_ID));
+    test_true(TNECS_ADD_C(lock_world, Es[0], Velocity_ID));
+    for (size_t i = 0; i < 10; i++)
+        test_true(tnecs_E_destroy(lock_world, Es[i]));
+    for (size_t i = 0; i < 10; i++) {
+        Es[i] = TNECS_E_CREATE_wC(lock_world, Position_ID, Velocity_ID);
+        test_true(Es[i] != TNECS_NULL);
+    }
+    tnecs_step(lock_world, 1, NULL);
+    test_true(track.allocs == allocs);
+    test_true(lock_world->counts.rejects == 0);
+
+    /* Growth and registration rejected */
+    test_true(TNECS_E_CREATE_wC(lock_world, Position_ID, Velocity_ID) == 0);
+    test_true(TNECS_E_CREATE_wC(lock_world, Unit_ID) == 0);
+    test_true(TNECS_ADD_C(lock_world, Es[1], Unit_ID) == 0);
+    test_true(TNECS_RM_C(lock_world, Es[1], Position_ID) == 0);
+    test_true(tnecs_register_Pi(lock_world) == 0);
+    test_true(lock_world->counts.rejects == 5);
+    test_true(track.allocs == allocs);
+    test_true(lock_world->Es.As[Es[1]] == A_PV);
+
+    /* Unlocked: growth again */
+    test_true(tnecs_W_lock(lock_world, 0));
+    test_true(TNECS_E_CREATE_wC(lock_world, Unit_ID) != 0);
+    test_true(track.allocs > allocs);
+
+    /* Full Es table: component changes need no entity slot */
+    test_true(tnecs_W_reserve(lock_world, A_P, 10));
+    while (lock_world->Es.num < lock_world->Es.len)
+        test_true(tnecs_E_create(lock_world));
+    test_true(tnecs_W_lock(lock_world, 1));
+    size_t rejects = lock_world->counts.rejects;
+    test_true(tnecs_E_create(lock_world) == TNECS_NULL);
+    test_true(lock_world->counts.rejects == (rejects + 1));
+    test_true(TNECS_RM_C(lock_world, Es[2], Velocity_ID));
+    test_true(lock_world->Es.As[Es[2]] == A_P);
+    test_true(TNECS_ADD_C(lock_world, Es[2], Velocity_ID));
+    test_true(lock_world->Es.As[Es[2]] == A_PV);
+    test_true(lock_world->counts.rejects == (rejects + 1));
+    tnecs_finale(&lock_world);
+    test_true(track.live == 0);
+
+    /* Locked growth rejected: arrays kept, usable when unlocked */
+    tnecs_W *grow_world = NULL;
+    test_true(tnecs_genesis_alloc(&grow_world, &alloc));
+    TNECS_REGISTER_C(grow_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(grow_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_C(grow_world, Unit,      NULL, NULL);
+    TNECS_REGISTER_S(grow_world, SystemMove, 0, 0, 0, Position_ID, Velocity_ID);
+    tnecs_W_reuse_E(grow_world, 0);
+    tnecs_E grow_Es[300];
+    for (size_t i = 0; i < 300; i++)
+        test_true(grow_Es[i] = tnecs_E_create(grow_world));
+    for (size_t i = 0; i < 300; i++)
+        test_true(tnecs_E_destroy(grow_world, grow_Es[i]));
+    for (size_t i = 0; i < 10; i++)
+        test_true(TNECS_E_CREATE_wC(grow_world, Position_ID, Velocity_ID));
+    /* Command buffer allocated before locking */
+    test_true(tnecs_cmd_destroy(grow_world, grow_Es[0]));
+    test_true(tnecs_cmds_apply(grow_world));
+    test_true(tnecs_W_lock(grow_world, 1));
+    rejects = grow_world->counts.rejects;
+
+    /* Open list can't fit every null E */
+    tnecs_E *open   = grow_world->Es.open.arr;
+    size_t open_len = grow_world->Es.open.len;
+    test_true(tnecs_E_open_find(grow_world) == 0);
+    test_true(grow_world->Es.open.arr == open);
+    test_true(grow_world->Es.open.len == open_len);
+    test_true(grow_world->Es.open.num == 0);
+
+    /* Phase steps: debug ran arrays never grow */
+    for (size_t i = 0; i < 40; i++)
+        test_true(tnecs_step_Pi_Ph(grow_world, 1, NULL, 0, 0));
+    test_true(grow_world->Ss.to_run.num == 1);
+    test_true(grow_world->Ss.ran.arr != NULL);
+
+    /* Create of unregistered A: rejected before creating E */
+    tnecs_C A_PU = TNECS_C_IDS2A(Position_ID, Unit_ID);
+    test_true(tnecs_cmd_create(grow_world, A_PU, NULL));
+    size_t num_Es   = grow_world->Es.num;
+    size_t num_E0   = grow_world->byA.arr[TNECS_NULL].num_Es;
+    test_true(tnecs_cmds_apply(grow_world) == 0);
+    test_true(grow_world->Es.num == num_Es);
+    test_true(grow_world->byA.arr[TNECS_NULL].num_Es == num_E0);
+    test_true(grow_world->cmds.num == 1);
+
+    /* Deltas: rejected before reading */
+    FILE *delta = tmpfile();
+    test_true(delta != NULL);
+    test_true(tnecs_W_apply(grow_world, delta) == 0);
+    test_true(ftell(delta) == 0);
+    fclose(delta);
+    test_true(grow_world->counts.rejects == (rejects + 3));
+
+    /* Unlocked: same ops grow */
+    test_true(tnecs_W_lock(grow_world, 0));
+    test_true(tnecs_cmds_apply(grow_world));
+    test_true(tnecs_E_open_find(grow_world));
+    test_true(grow_world->Es.open.num == 300);
+    for (size_t i = 0; i < 300; i++)
+        test_true(TNECS_E_CREATE_wC(grow_world, Position_ID, Velocity_ID));
+    test_true(tnecs_step(grow_world, 1, NULL));
+    test_true(grow_world->Ss.ran.num == 1);
+    tnecs_finale(&grow_world);
+    test_true(track.live == 0);
+}
+
+void tnecs_test_idle(void) {
+    int Position_ID = 1;
+    int Velocity_ID = 2;
+
+    tnecs_W *idle_world = NULL;
+    tnecs_Config config = {0};
+    config.high = 1.5;
+    test_true(tnecs_genesis_config(&idle_world, &config, NULL) == 0);
+    config.high = 0.5;
+    test_true(tnecs_genesis_config(&idle_world, &config, NULL));
+    test_true(idle_world->config.high == 0.5);
+    TNECS_REGISTER_C(idle_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(idle_world, Velocity,  NULL, NULL);
+    TNECS_REGISTER_S(idle_world, SystemMove, 0, 0, 0, Position_ID, Velocity_ID);
+
+    /* Warmup: growth in creates */
+    size_t reallocs = idle_world->counts.reallocs;
+    for (size_t i = 0; i < 64; i++)
+        TNECS_E_CREATE_wC(idle_world, Position_ID, Velocity_ID);
+    test_true(idle_world->counts.reallocs > reallocs);
+
+    /* Idle between frames: no growth in creates */
+    for (size_t frame = 0; frame < 200; frame++) {
+        test_true(tnecs_W_idle(idle_world, 0));
+        reallocs = idle_world->counts.reallocs;
+        for (size_t i = 0; i < 16; i++)
+            TNECS_E_CREATE_wC(idle_world, Position_ID, Velocity_ID);
+        test_true(idle_world->counts.reallocs == reallocs);
+    }
+    tnecs_step(idle_world, 1, NULL);
+    test_true(idle_world->Es.len > 3200);
+
+    /* Budget: growths only within it */
+    tnecs_E Es[256];
+    for (size_t i = 0; i < 256; i++)
+        Es[i] = TNECS_E_CREATE_wC(idle_world, Position_ID);
+    for (size_t i = 0; i < 256; i++)
+        TNECS_ADD_C(idle_world, Es[i], Velocity_ID);
+    for (size_t i = 0; i < 256; i++)
+        TNECS_E_CREATE_wC(idle_world, Velocity_ID);
+    tnecs_C A_P = TNECS_C_IDS2A(Position_ID);
+    tnecs_C A_V = TNECS_C_IDS2A(Velocity_ID);
+    size_t tID_P = tnecs_A_id(idle_world, A_P);
+    size_t tID_V = tnecs_A_id(idle_world, A_V);
+    TNECS_RM_C(idle_world, Es[0], Velocity_ID);
+    size_t len_P = idle_world->byA.arr[tID_P].len_Es;
+    size_t len_V = idle_world->byA.arr[tID_V].len_Es;
+    size_t copied = idle_world->counts.bytes_copied;
+    test_true(tnecs_W_idle(idle_world, 1));
+    test_true(idle_world->byA.arr[tID_P].len_Es == len_P);
+    test_true(idle_world->byA.arr[tID_V].len_Es == len_V);
+    test_true(idle_world->counts.bytes_copied == copied);
+    size_t budget = tnecs_byA_cost(idle_world, tID_V, len_V + 1);
+    test_true(tnecs_W_idle(idle_world, budget));
+    test_true(idle_world->counts.bytes_copied <= (copied + budget));
+    test_true(tnecs_W_idle(idle_world, 0));
+    test_true(idle_world->byA.arr[tID_V].len_Es > len_V);
+
+    /* Budget smaller than one Es growth: Es not grown */
+    while (!tnecs_high(idle_world, idle_world->Es.num, idle_world->Es.len))
+        tnecs_E_create(idle_world);
+    size_t len_Es = idle_world->Es.len;
+    copied = idle_world->counts.bytes_copied;
+    budget = len_Es * sizeof(tnecs_E);
+    test_true(tnecs_W_idle(idle_world, budget));
+    test_true(idle_world->Es.len == len_Es);
+    test_true(idle_world->counts.bytes_copied <= (copied + budget));
+    test_true(tnecs_W_idle(idle_world, 0));
+    test_true(idle_world->Es.len > len_Es);
+
+    /* Locked: nothing grows */
+    test_true(tnecs_W_lock(idle_world, 1));
+    test_true(tnecs_W_idle(idle_world, 0));
+    test_true(idle_world->counts.rejects == 0);
+    tnecs_finale(&idle_world);
+}
+
+size_t cmd_counted = 0;
+
+void SystemCmdSpawn(struct tnecs_In *input) {
+    /* Position Cs: x == 0 destroyed, x == 1 spawn & get Unit */
+    tnecs_W *W = input->world;
+    struct Position *p = TNECS_C_ARRAY(input, 1);
+    tnecs_byte Cs[sizeof(Position) + sizeof(Unit)] = {0};
+    Position spawn_p = {.x = 2};
+    Unit     spawn_u = {.hp = 7};
+    Unit     unit    = {.hp = 3};
+    memcpy(Cs, &spawn_p, sizeof(spawn_p));
+    memcpy(Cs + sizeof(spawn_p), &spawn_u, sizeof(spawn_u));
+    for (size_t i = 0; i < input->num_Es; i++) {
+        tnecs_E E = input->Es[i];
+        if (p[i].x == 0) {
+            test_true(tnecs_cmd_destroy(W, E));
+        } else if (p[i].x == 1) {
+            test_true(tnecs_cmd_create(W, TNECS_C_IDS2A(1, 2), Cs));
+            test_true(tnecs_cmd_add_C(W, E, TNECS_C_IDS2A(2), &unit));
+        }
+    }
+    /* Structure unchanged until end of phase */
+    test_true(W->cmds.num > 0);
+}
+
+void SystemCmdCount(struct tnecs_In *input) {
+    cmd_counted += input->num_Es;
+}
+
+void tnecs_test_cmds(void) {
+    int Position_ID = 1;
+    int Unit_ID     = 2;
+
+    tnecs_W *cmd_world = NULL;
+    test_true(tnecs_genesis(&cmd_world));
+    TNECS_REGISTER_C(cmd_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(cmd_world, Unit,      NULL, NULL);
+    tnecs_register_Ph(cmd_world, 0);
+    TNECS_REGISTER_S(cmd_world, SystemCmdSpawn, 0, 0, 0, Position_ID);
+    TNECS_REGISTER_S(cmd_world, SystemCmdCount, 0, 1, 0, Unit_ID);
+
+    tnecs_E Es[10];
+    for (size_t i = 0; i < 10; i++) {
+        Es[i] = TNECS_E_CREATE_wC(cmd_world, Position_ID);
+        struct Position *p = tnecs_get_C(cmd_world, Es[i], Position_ID);
+        p->x = i % 2;
+    }
+    size_t num_Es = cmd_world->Es.num;
+
+    /* Applied at end of phase 0: phase 1 sees them */
+    test_true(tnecs_step(cmd_world, 1, NULL));
+    test_true(cmd_world->cmds.num == 0);
+    test_true(cmd_counted == 10);
+    test_true(cmd_world->Es.num == (num_Es + 5));
+    for (size_t i = 0; i < 10; i++) {
+        if (i % 2 == 0) {
+            test_true(!TNECS_E_EXISTS(cmd_world, Es[i]));
+            continue;
+        }
+        struct Unit *u = tnecs_get_C(cmd_world, Es[i], Unit_ID);
+        test_true(u != NULL);
+        test_true(u->hp == 3);
+    }
+    for (tnecs_E E = num_Es; E < (num_Es + 5); E++) {
+        struct Position *p = tnecs_get_C(cmd_world, E, Position_ID);
+        struct Unit     *u = tnecs_get_C(cmd_world, E, Unit_ID);
+        test_true(p->x  == 2);
+        test_true(u->hp == 7);
+        test_true(cmd_world->Es.Os[E] == (5 + E - num_Es));
+    }
+
+    /* Outside systems: applied on demand, in order */
+    test_true(tnecs_cmd_rm_C(cmd_world, Es[1], TNECS_C_IDS2A(Unit_ID)));
+    test_true(tnecs_cmd_destroy(cmd_world, Es[3]));
+    test_true(tnecs_cmd_add_C(cmd_world, Es[3], TNECS_C_IDS2A(Unit_ID), NULL));
+    test_true(tnecs_cmd_create(cmd_world, TNECS_NULL, NULL));
+    test_true(tnecs_cmd_add_C(cmd_world, Es[1], 1ULL << 10, NULL) == 0);
+    test_true(cmd_world->Es.As[Es[1]] == TNECS_C_IDS2A(Position_ID, Unit_ID));
+    test_true(tnecs_cmds_apply(cmd_world));
+    test_true(cmd_world->Es.As[Es[1]] == TNECS_C_IDS2A(Position_ID));
+    test_true(!TNECS_E_EXISTS(cmd_world, Es[3]));
+    test_true(cmd_world->Es.num == (num_Es + 6));
+
+    /* Failed apply: applied commands dropped, never twice */
+    tnecs_C A_U = TNECS_C_IDS2A(Unit_ID);
+    size_t tID_U = tnecs_A_id(cmd_world, A_U);
+    size_t num_U = cmd_world->byA.arr[tID_U].num_Es;
+    test_true(tnecs_W_reserve(cmd_world, A_U, 2));
+    test_true(tnecs_W_lock(cmd_world, 1));
+    test_true(tnecs_cmd_destroy(cmd_world, Es[5]));
+    for (size_t i = 0; i < 8; i++)
+        test_true(tnecs_cmd_create(cmd_world, A_U, NULL));
+    test_true(tnecs_cmds_apply(cmd_world) == 0);
+    size_t created = cmd_world->byA.arr[tID_U].num_Es - num_U;
+    test_true(created > 0);
+    test_true(created < 8);
+    test_true(!TNECS_E_EXISTS(cmd_world, Es[5]));
+    test_true(cmd_world->cmds.num == (8 - created));
+    test_true(tnecs_W_lock(cmd_world, 0));
+    test_true(tnecs_cmds_apply(cmd_world));
+    test_true(cmd_world->cmds.num == 0);
+    test_true(cmd_world->byA.arr[tID_U].num_Es == (num_U + 8));
+    tnecs_finale(&cmd_world);
+
+#ifdef TNECS_RECORD
+    /* Recorded commands replay: archetypes registered by creates */
+    test_true(tnecs_genesis(&cmd_world));
+    FILE *f = tmpfile();
+    test_true(tnecs_record_start(cmd_world, f));
+    TNECS_REGISTER_C(cmd_world, Position,  NULL, NULL);
+    TNECS_REGISTER_C(cmd_world, Unit,      NULL, NULL);
+    tnecs_E E = TNECS_E_CREATE_wC(cmd_world, Position_ID);
+    Unit unit = {.hp = 4};
+    for (size_t i = 0; i < 3; i++)
+        test_true(tnecs_cmd_create(cmd_world, TNECS_C_IDS2A(Unit_ID), &unit));
+    test_true(tnecs_cmd_create(cmd_world,
+                               TNECS_C_IDS2A(Position_ID, Unit_ID), NULL));
+    test_true(tnecs_cmd_rm_C(cmd_world, E, TNECS_C_IDS2A(Position_ID)));
+    test_true(tnecs_cmds_apply(cmd_world));
+    tnecs_record_stop(cmd_world);
+    rewind(f);
+    tnecs_W *replay_world = NULL;
+    test_true(tnecs_genesis(&replay_world));
+    test_true(test_rec_replay(f, replay_world));
+    fclose(f);
+    test_true(replay_world->Es.num  == cmd_world->Es.num);
+    test_true(replay_world->byA.num == cmd_world->byA.num);
+    for (E = 1; E < cmd_world->Es.num; E++) {
+        test_true(replay_world->Es.As[E] == cmd_world->Es.As[E]);
+        test_true(replay_world->Es.Os[E] == cmd_world->Es.Os[E]);
+    }
+    tnecs_finale(&replay_world);
+    tnecs_finale(&cmd_world);
+#endif /* TNECS_RECORD */
+}
+
+void SystemCmdSpawnX(struct tnecs_In *input) {
+    /* data: per-thread buffers, else W's buffer */
+    tnecs_Cmds *bufs = input->data;
+    struct Position *p = TNECS_C_ARRAY(input, 1);
+    for (size_t i = 0; i < input->num_Es; i++) {
+        Position spawn = {.x = p[i].x + 10};
+        if (bufs != NULL)
+            tnecs_cmds_push(&bufs[input->S_id % 2], input,
+                            TNECS_CMD_CREATE, TNECS_NULL,
+                            TNECS_C_IDS2A(1), &spawn);
+        else
+            tnecs_cmd_create(input->world, TNECS_C_IDS2A(1), &spawn);
+    }
+}
+
+void SystemCmdKill(struct tnecs_In *input) {
+    tnecs_Cmds *bufs = input->data;
+    struct Position *p = TNECS_C_ARRAY(input, 1);
+    for (size_t i = 0; i < input->num_Es; i++) {
+        if (p[i].x % 3 != 0)
+            continue;
+        if (bufs != NULL) {
+            tnecs_cmds_push(&bufs[input->S_id % 2], input,
+                            TNECS_CMD_DESTROY, input->Es[i], 0, NULL);
+            tnecs_cmds_push(&bufs[input->S_id % 2], input,
+                            TNECS_CMD_CREATE, TNECS_NULL,
+                            TNECS_C_IDS2A(2), NULL);
+        } else {
+            tnecs_cmd_destroy(input->world, input->Es[i]);
+            tnecs_cmd_create(input->world, TNECS_C_IDS2A(2), NULL);
+        }
+    }
+}
+
+void tnecs_test_cmds_merge(void) {
+    int Position_ID = 1;
+    int Unit_ID     = 2;
+
+    /* Serial step vs systems run in reverse, per-thread buffers */
+    tnecs_W *Ws[2] = {NULL, NULL};
+    size_t S_ids[2];
+    for (int w = 0; w < 2; w++) {
+        test_true(tnecs_genesis(&Ws[w]));
+        tnecs_W_reuse_E(Ws[w], 1);
+        TNECS_REGISTER_C(Ws[w], Position,  NULL, NULL);
+        TNECS_REGISTER_C(Ws[w], Unit,      NULL, NULL);
+        S_ids[0] = TNECS_REGISTER_S(Ws[w], SystemCmdSpawnX, 0, 0, 0, Position_ID);
+        S_ids[1] = TNECS_REGISTER_S(Ws[w], SystemCmdKill,   0, 0, 0, Position_ID);
+        for (size_t i = 0; i < 32; i++) {
+            tnecs_E E = TNECS_E_CREATE_wC(Ws[w], Position_ID);
+            struct Position *p = tnecs_get_C(Ws[w], E, Position_ID);
+            p->x = i;
+            if (i % 4 == 0)
+                TNECS_ADD_C(Ws[w], E, Unit_ID);
+        }
+    }
+    test_true(tnecs_step(Ws[0], 1, NULL));
+
+    Track track = {0};
+    tnecs_Alloc alloc = {track_alloc, NULL, track_free, &track};
+    tnecs_Cmds bufs[2];
+    test_true(tnecs_cmds_genesis(&bufs[0], &alloc));
+    test_true(tnecs_cmds_genesis(&bufs[1], &alloc));
+    test_true(tnecs_S_run(Ws[1], S_ids[1], 1, bufs));
+    test_true(tnecs_S_run(Ws[1], S_ids[0], 1, bufs));
+    test_true(Ws[1]->cmds.num == 0);
+    test_true(bufs[0].num > 0);
+    test_true(bufs[1].num > 0);
+    test_true(tnecs_cmds_merge(Ws[1], bufs, 2));
+    test_true(bufs[0].num == 0);
+    test_true(tnecs_cmds_apply(Ws[1]));
+
+    /* Same ids, archetypes & layouts */
+    test_true(Ws[0]->Es.num == Ws[1]->Es.num);
+    for (tnecs_E E = 1; E < Ws[0]->Es.num; E++) {
+        test_true(Ws[0]->Es.id[E] == Ws[1]->Es.id[E]);
+        test_true(Ws[0]->Es.As[E] == Ws[1]->Es.As[E]);
+        test_true(Ws[0]->Es.Os[E] == Ws[1]->Es.Os[E]);
+        struct Position *p0 = tnecs_get_C(Ws[0], E, Position_ID);
+        struct Position *p1 = tnecs_get_C(Ws[1], E, Position_ID);
+        test_true((p0 == NULL) == (p1 == NULL));
+        test_true((p0 == NULL) || (p0->x == p1->x));
+    }
+    test_true(tnecs_cmds_finale(&bufs[0]));
+    test_true(tnecs_cmds_finale(&bufs[1]));
+    test_true(track.live == 0);
+    test_true(track.allocs > 0);
+    tnecs_finale(&Ws[0]);
+    tnecs_finale(&Ws[1]);
+}
+
+void tnecs_test_reserve_ids(void) {
+    int Position_ID = 1;
+
+    tnecs_W *rsv_world = NULL;
+    test_true(tnecs_genesis(&rsv_world));
+    tnecs_W_reuse_E(rsv_world, 1);
+    TNECS_REGISTER_C(rsv_world, Position,  NULL, NULL);
+    tnecs_E Es[8];
+    for (size_t i = 0; i < 8; i++)
+        Es[i] = TNECS_E_CREATE_wC(rsv_world, Position_ID);
+    tnecs_E_destroy(rsv_world, Es[2]);
+    tnecs_E_destroy(rsv_world, Es[5]);
+    size_t num_Es = rsv_world->Es.num;
+
+    /* Outside reservation: no ids */
+    test_true(tnecs_E_reserve(rsv_world) == TNECS_NULL);
+
+    test_true(tnecs_W_ids(rsv_world, 100));
+    test_true(tnecs_W_ids(rsv_world, 100) == 0);
+    test_true(rsv_world->Es.len > (num_Es + 100));
+    /* Open list first, then bumped */
+    test_true(tnecs_E_reserve(rsv_world) == Es[5]);
+    test_true(tnecs_E_reserve(rsv_world) == Es[2]);
+    tnecs_E first = tnecs_E_reserve(rsv_world);
+    test_true(first == num_Es);
+    tnecs_E block = tnecs_E_reserve_n(rsv_world, 50);
+    test_true(block == (num_Es + 1));
+    test_true(tnecs_E_reserve_n(rsv_world, 50) == TNECS_NULL);
+    test_true(tnecs_E_reserve_n(rsv_world, 49) == (num_Es + 51));
+    test_true(tnecs_E_reserve(rsv_world) == TNECS_NULL);
+    /* Reserved, not yet created */
+    test_true(!TNECS_E_EXISTS(rsv_world, Es[2]));
+    test_true(!TNECS_E_EXISTS(rsv_world, block));
+    test_true(rsv_world->Es.num == num_Es);
+
+    test_true(tnecs_E_sync(rsv_world));
+    test_true(rsv_world->Es.num == (num_Es + 100));
+    test_true(rsv_world->Es.open.num == 0);
+    test_true(TNECS_E_EXISTS(rsv_world, Es[2]));
+    test_true(TNECS_E_EXISTS(rsv_world, Es[5]));
+    for (tnecs_E E = num_Es; E < (num_Es + 100); E++) {
+        test_true(TNECS_E_EXISTS(rsv_world, E));
+        test_true(rsv_world->Es.As[E] == TNECS_NULL);
+    }
+    test_true(rsv_world->byA.arr[TNECS_NULL].num_Es == 102);
+    test_true(TNECS_ADD_C(rsv_world, block, Position_ID));
+    test_true(tnecs_E_reserve(rsv_world) == TNECS_NULL);
+    test_true(tnecs_E_create(rsv_world) == (num_Es + 100));
+    tnecs_finale(&rsv_world);
+}
+
+void tnecs_test_gen(void) {
+    int Position_ID = 1;
+
+    tnecs_W *gen_world = NULL;
+    test_true(tnecs_genesis(&gen_world));
+    tnecs_W_reuse_E(gen_world, 1);
+    TNECS_REGISTER_C(gen_world, Position,  NULL, NULL);
+    /* No generations: handles are indices, all bits */
+    test_true(TNECS_E_IDX(gen_world, 1ULL << 40) == (1ULL << 40));
+    tnecs_E old = TNECS_E_CREATE_wC(gen_world, Position_ID);
+    /* Live Es keep their handle */
+    test_true(tnecs_W_gen_E(gen_world, 1));
+    test_true(TNECS_E_EXISTS(gen_world, old));
+    test_true(TNECS_E_GEN(old) == 0);
+
+    /* Open list membership */
+    tnecs_E Es[100];
+    for (size_t i = 0; i < 100; i++)
+        Es[i] = TNECS_E_CREATE_wC(gen_world, Position_ID);
+    test_true(tnecs_E_destroy(gen_world, old));
+    test_true(tnecs_E_isOpen(gen_world, old));
+    test_true(!tnecs_E_isOpen(gen_world, Es[0]));
+    test_true(!tnecs_E_isOpen(gen_world, TNECS_NULL));
+
+    /* Reused index: new generation, old handle is stale */
+    tnecs_E E = TNECS_E_CREATE_wC(gen_world, Position_ID);
+    test_true(TNECS_E_IDX(gen_world, E) == TNECS_E_IDX(gen_world, old));
+    test_true(TNECS_E_GEN(E) == 1);
+    test_true(!tnecs_E_isOpen(gen_world, E));
+    test_true(!TNECS_E_EXISTS(gen_world, old));
+    test_true(TNECS_E_EXISTS(gen_world, E));
+    test_true(tnecs_get_C(gen_world, old, Position_ID) == NULL);
+    Position *pos = tnecs_get_C(gen_world, E, Position_ID);
+    test_true(pos != NULL);
+    pos->x = 3;
+
+    /* Stale handle leaves new E alone */
+    test_true(TNECS_RM_C(gen_world, old, Position_ID) == TNECS_NULL);
+    test_true(TNECS_E_A(gen_world, E) == TNECS_C_ID2T(Position_ID));
+    test_true(pos->x == 3);
+    test_true(tnecs_E_destroy(gen_world, old));
+    test_true(TNECS_E_EXISTS(gen_world, E));
+    test_true(TNECS_E_A(gen_world, E) == TNECS_C_ID2T(Position_ID));
+    size_t O = gen_world->Es.Os[TNECS_E_IDX(gen_world, E)];
+    test_true(tnecs_E_destroy(gen_world, old));
+    test_true(gen_world->Es.Os[TNECS_E_IDX(gen_world, E)] == O);
+    /* Live Es with generations: can't go back to indices */
+    test_true(!tnecs_W_gen_E(gen_world, 0));
+    test_true(gen_world->gen_Es);
+
+    /* Clone and delta keep handles */
+    tnecs_W *base = NULL, *clone = NULL;
+    test_true(tnecs_W_clone(gen_world, &base));
+    test_true(tnecs_E_destroy(gen_world, E));
+    test_true(tnecs_E_destroy(gen_world, Es[7]));
+    tnecs_E E2 = TNECS_E_CREATE_wC(gen_world, Position_ID);
+    test_true(TNECS_E_IDX(gen_world, E2) == TNECS_E_IDX(gen_world, Es[7]));
+    test_true(TNECS_E_GEN(E2) == 1);
+    test_true(tnecs_W_clone(base, &clone));
+    FILE *f = tmpfile();
+    test_true(tnecs_W_diff(base, gen_world, f));
+    rewind(f);
+    test_true(tnecs_W_apply(clone, f));
+    fclose(f);
+    test_true(!TNECS_E_EXISTS(clone, E));
+    test_true(!TNECS_E_EXISTS(clone, Es[7]));
+    test_true(TNECS_E_EXISTS(clone, E2));
+    test_true(tnecs_E_isOpen(clone, E));
+    test_true(!tnecs_E_isOpen(clone, E2));
+    test_true(TNECS_E_GEN(tnecs_E_create(clone)) == 2);
+    tnecs_finale(&clone);
+    tnecs_finale(&base);
+
+    /* open_find rebuilds open list */
+    test_true(tnecs_E_open_flush(gen_world));
+    test_true(!tnecs_E_isOpen(gen_world, E));
+    test_true(tnecs_E_open_find(gen_world));
+    test_true(tnecs_E_isOpen(gen_world, E));
+    test_true(gen_world->Es.open.num == 1);
+    tnecs_finale(&gen_world);
+}
+
 void Position_Init(void *voidpos) {
     struct Position *pos = voidpos;
     pos->arr_len = 10;
@@ -1454,6 +2901,29 @@ int main() {
     lrun("progress",    tnecs_test_world_progress);
     lrun("finit_ffree", tnecs_test_finit_ffree);
     lrun("Pis",   tnecs_test_Pis);
+    lrun("plan",        tnecs_test_plan);
+    lrun("S_batch",     tnecs_test_S_batch);
+#ifdef TNECS_PROFILE
+    lrun("profile",     tnecs_test_profile);
+#endif /* TNECS_PROFILE */
+#ifdef TNECS_TRACE
+    lrun("trace",       tnecs_test_trace);
+#endif /* TNECS_TRACE */
+    lrun("stats",       tnecs_test_stats);
+#ifdef TNECS_RECORD
+    lrun("record",      tnecs_test_record);
+#endif /* TNECS_RECORD */
+    lrun("save",        tnecs_test_save);
+    lrun("delta",       tnecs_test_delta);
+    lrun("clone",       tnecs_test_clone);
+    lrun("alloc",       tnecs_test_alloc);
+    lrun("config",      tnecs_test_config);
+    lrun("lock",        tnecs_test_lock);
+    lrun("idle",        tnecs_test_idle);
+    lrun("cmds",        tnecs_test_cmds);
+    lrun("cmds_merge",  tnecs_test_cmds_merge);
+    lrun("reserve_ids", tnecs_test_reserve_ids);
+    lrun("gen",         tnecs_test_gen);
     lresults();
 
     dupprintf(globalf, "\n --- Notes ---\n");
@@ -1461,23 +2931,6 @@ int main() {
     dupprintf(globalf, "%d frame %d fps, ", fps_iterations, 60);
     dupprintf(globalf, "%.1f [us] \n\n", fps_iterations / 60.0f * 1e6);
 
-    srand(time(NULL));   // Initialization, should only be called once.
-    dupprintf(globalf, " --- tnecs benchmarks: %d iterations ---\n", ITERATIONS);
-    dupprintf(globalf, "Entities [num]\t");
-    dupprintf(globalf, "Genesis\t"); 
-    dupprintf(globalf, "cRegist\t");
-    dupprintf(globalf, "sRegist\t");
-    dupprintf(globalf, "eCreate\t");
-    dupprintf(globalf, "eDestro\t");
-    dupprintf(globalf, "eAddCom\t");
-    dupprintf(globalf, "eCreawC\t");
-    dupprintf(globalf, "eCrewCs\t");
-    dupprintf(globalf, "compGet\t");
-    dupprintf(globalf, "wrlStep\t");
-    dupprintf(globalf, "wDestroy [us]\n");
-    // for (uint64_t num = 1; num < 2e6; num *= 2)
-    //     tnecs_benchmarks(num);
-
     tnecs_finale(&test_world);
     dupprintf(globalf, "\n --- tnecs test end ---\n\n");
     fclose(globalf);
@@ -15,19 +15,116 @@
 **      
 */
 
+/* Clock is POSIX, not C99 */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 199309L
+#endif /* _POSIX_C_SOURCE */
+
 #include "tnecs.h"
 
+#ifdef TNECS_MMAP
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif /* TNECS_MMAP */
+
 /* --- Early return on fail --- */
 #define TNECS_CHECK(check) do {\
-        if (!check) { \
-            printf("tnecs: failed " #check "\n"); \
+        if (!(check)) { \
+            printf("tnecs: failed %s\n", #check); \
             return(0); \
         } \
     } while (0)
 
+/* --- Bulk I/O, num elements of ptr --- */
+#define TNECS_WRITE(f, ptr, num) \
+    (((num) == 0) || (fwrite((ptr), sizeof(*(ptr)), (num), (f)) == (num)))
+#define TNECS_READ(f, ptr, num) \
+    (((num) == 0) || (fread((ptr), sizeof(*(ptr)), (num), (f)) == (num)))
+
+/* --- Clone: replace ptr by copy, num used of len --- */
+#define TNECS_DUP_N(W, ptr, num, len, bytesize) \
+    (((ptr) == NULL) || \
+     (((ptr) = tnecs_dup((W), (ptr), (num), (len), (bytesize))) != NULL))
+#define TNECS_DUP(W, ptr, len) \
+    TNECS_DUP_N(W, ptr, len, len, sizeof(*(ptr)))
+
+/* --- Atomics for id reservation --- */
+#if defined(TNECS_ATOMICS_C11)
+    #define TNECS_LOAD(p)       atomic_load(p)
+    #define TNECS_STORE(p, v)   atomic_store(p, v)
+    #define TNECS_CAS(p, o, n)  atomic_compare_exchange_weak(p, o, n)
+#elif defined(__GNUC__)
+    #define TNECS_LOAD(p)       __atomic_load_n(p, __ATOMIC_SEQ_CST)
+    #define TNECS_STORE(p, v)   __atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+    #define TNECS_CAS(p, o, n)  __atomic_compare_exchange_n(p, o, n, 1, \
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#else
+    /* Single thread */
+    #define TNECS_LOAD(p)       (*(p))
+    #define TNECS_STORE(p, v)   (*(p) = (v))
+    #define TNECS_CAS(p, o, n)  ((*(p) == *(o)) ? (*(p) = (n), 1) : \
+                                                  (*(o) = *(p), 0))
+#endif /* TNECS_ATOMICS_C11 */
+
+/* --- Open list membership, one bit per E --- */
+#define TNECS_BITS_LEN(len)     (((len) / 64) + 1)
+#define TNECS_BIT_SET(bits, i)  ((bits)[(i) / 64] |=  (1ULL << ((i) % 64)))
+#define TNECS_BIT_CLR(bits, i)  ((bits)[(i) / 64] &= ~(1ULL << ((i) % 64)))
+#define TNECS_BIT_GET(bits, i)  (((bits)[(i) / 64] >> ((i) % 64)) & 1ULL)
+
 /* --- PRIVATE DECLARATIONS --- */
 typedef unsigned char tnecs_byte;
 
+#if defined(TNECS_PROFILE) || defined(TNECS_TRACE)
+/* Clock: override with TNECS_NOW, in [ns].
+** No CLOCK_MONOTONIC: clock(), CPU time, coarse */
+    #ifndef TNECS_NOW
+        #if defined(CLOCK_MONOTONIC)
+static tnecs_ns tnecs_now(void) {
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return ((tnecs_ns)spec.tv_sec * 1000000000ULL + spec.tv_nsec);
+}
+        #else
+static tnecs_ns tnecs_now(void) {
+    return ((tnecs_ns)clock() * (1000000000ULL / CLOCKS_PER_SEC));
+}
+        #endif
+        #define TNECS_NOW() tnecs_now()
+    #endif /* TNECS_NOW */
+#endif /* TNECS_PROFILE || TNECS_TRACE */
+
+#ifdef TNECS_TRACE
+    #ifndef TNECS_TRACE_LEN
+        #define TNECS_TRACE_LEN 4096
+    #endif /* TNECS_TRACE_LEN */
+static void tnecs_trace(tnecs_W *w,   int kind, char ph,
+                        size_t  id, size_t arg);
+    #define TNECS_TRACE_B(W, kind, id, arg) \
+        tnecs_trace(W, kind, 'B', id, arg)
+    #define TNECS_TRACE_E(W, kind, id, arg) \
+        tnecs_trace(W, kind, 'E', id, arg)
+#else
+    #define TNECS_TRACE_B(W, kind, id, arg)
+    #define TNECS_TRACE_E(W, kind, id, arg)
+#endif /* TNECS_TRACE */
+static int tnecs_trace_paired(const tnecs_W *w, size_t first, size_t i);
+
+#ifdef TNECS_RECORD
+static void tnecs_record(tnecs_W *w, int op, size_t num,
+                         const unsigned long long *args);
+    #define TNECS_REC(W, op, ...) do { \
+            if ((W)->record != NULL) { \
+                const unsigned long long args[] = {__VA_ARGS__}; \
+                tnecs_record(W, op, sizeof(args) / sizeof(*args), args); \
+            } \
+        } while (0)
+#else
+    #define TNECS_REC(W, op, ...)
+#endif /* TNECS_RECORD */
+
 enum TNECS_PRIVATE {
     TNECS_E_0LEN    = 128,
     TNECS_Ph_0LEN   =   4,
@@ -35,35 +132,80 @@ enum TNECS_PRIVATE {
     TNECS_C_0LEN    =   8,
     TNECS_S_0LEN    =  16,
     TNECS_A_0LEN    =  16,
+    TNECS_subA_0LEN =   8,
+    TNECS_CMD_0LEN  =  64,
+    TNECS_CMD_0BYTES = 1024,
     TNECS_ARR_GROW  =   2
 };
 
+/* Config: default if unset */
+#define TNECS_OR(val, def) (((val) > 0) ? (val) : (def))
+/* Idle growth: arrays filled above len * high */
+#define TNECS_HIGH 0.75
+
+/* Archetype Cs block: one column & its C_id per component */
+#define TNECS_ARCH_C_BYTES (sizeof(tnecs_C_arr) + sizeof(tnecs_C))
+
+/* Archetype hot fields adjacent, in first 64 bytes of record */
+#define TNECS_CACHE_LINE 64
+typedef char tnecs_Arch_hot_check[
+    (offsetof(tnecs_Arch, Cs_O) <= TNECS_CACHE_LINE) ? 1 : -1];
+
 /* --- WORLD FUNCTIONS --- */
-static int _tnecs_breath_C(     tnecs_Cs    *Cs);
-static int _tnecs_breath_As(    tnecs_As    *byA);
-static int _tnecs_breath_Es(    tnecs_Es    *Es);
-static int _tnecs_breath_Ss(    tnecs_Ss    *Ss);
-static int _tnecs_breath_Phs(   tnecs_Phs   *byPh);
-static int _tnecs_breath_Pis(   tnecs_Pis   *Pis);
-
-static int _tnecs_finale_Ss(    tnecs_Ss    *Ss);
-static int _tnecs_finale_Es(    tnecs_Es    *Es);
-static int _tnecs_finale_As(    tnecs_As    *byA);
-static int _tnecs_finale_Phs(   tnecs_Phs   *byPh);
-static int _tnecs_finale_Pis(   tnecs_Pis   *Pis);
+static int _tnecs_breath_C(     tnecs_W *w, tnecs_Cs    *Cs);
+static int _tnecs_breath_As(    tnecs_W *w, tnecs_As    *byA);
+static int _tnecs_breath_Es(    tnecs_W *w, tnecs_Es    *Es);
+static int _tnecs_breath_Ss(    tnecs_W *w, tnecs_Ss    *Ss);
+static int _tnecs_breath_Phs(   tnecs_W *w, tnecs_Phs   *byPh);
+static int _tnecs_breath_Pis(   tnecs_W *w, tnecs_Pis   *Pis);
+static int _tnecs_breath_Plan(  tnecs_W *w, tnecs_Plan  *plan);
+
+static int _tnecs_finale_Ss(    tnecs_W *w, tnecs_Ss    *Ss);
+static int _tnecs_finale_Es(    tnecs_W *w, tnecs_Es    *Es);
+static int _tnecs_finale_As(    tnecs_W *w, tnecs_As    *byA);
+static int _tnecs_finale_Phs(   tnecs_W *w, tnecs_Phs   *byPh);
+static int _tnecs_finale_Pis(   tnecs_W *w, tnecs_Pis   *Pis);
+static int _tnecs_finale_Plan(  tnecs_W *w, tnecs_Plan  *plan);
+
+/* --- EXECUTION PLAN --- */
+static int  tnecs_plan_build(   tnecs_W *w);
+static int  tnecs_plan_resolve( tnecs_W *w);
+static size_t tnecs_plan_run(   tnecs_W *w, tnecs_In *in,
+                                size_t plan_O);
+static int  tnecs_plan_walk(    tnecs_W *w,     tnecs_ns dt,
+                                void    *data,  tnecs_Pi pi,
+                                tnecs_Ph ph0,   tnecs_Ph ph1);
+static void tnecs_plan_range(   const tnecs_W *const w,
+                                tnecs_Pi pi,    tnecs_Ph ph0,
+                                tnecs_Ph ph1,   size_t  *start,
+                                size_t  *end);
 
 /* --- REGISTRATION  --- */
 static size_t _tnecs_register_A( tnecs_W *w, size_t num_c,
                                  tnecs_C a);
+static size_t _tnecs_register_S( tnecs_W  *w,  tnecs_S_f  s,
+                                 tnecs_Pi  pi, tnecs_Ph   ph,
+                                 int       ex, size_t     num,
+                                 tnecs_C   a);
 
 /* --- SET BIT COUNTING --- */
 static size_t setBits_KnR(tnecs_C flags);
 
 /* --- "DYNAMIC" ARRAYS --- */
+static void *tnecs_calloc(  tnecs_W *w,  size_t num,
+                            size_t bytesize);
+static void  tnecs_free(    const tnecs_W *w, void  *ptr,
+                            size_t bytes);
+static void *tnecs_std_alloc(   void *ctx, size_t bytes);
+static void  tnecs_std_free(    void *ctx, void  *ptr,
+                                size_t bytes);
+static size_t tnecs_grow_len(const tnecs_W *w, size_t olen,
+                             size_t min);
 static void *tnecs_arrdel(  void *arr,  size_t elem,
                             size_t len, size_t bytesize);
-static void *tnecs_realloc( void *ptr,  size_t olen,
-                            size_t len, size_t bytesize);
+static void *tnecs_realloc( tnecs_W *w,  void  *ptr,
+                            size_t olen, size_t len,
+                            size_t bytesize);
 
 #ifndef NDEBUG
 static int tnecs_grow_ran(tnecs_W *w);
@@ -73,10 +215,101 @@ static int tnecs_grow_E(        tnecs_W *w);
 static int tnecs_grow_S(        tnecs_W *w);
 static int tnecs_grow_A(        tnecs_W *w);
 static int tnecs_grow_Pi(       tnecs_W *w);
+static int tnecs_grow_plan(     tnecs_W *w, size_t      len);
 static int tnecs_grow_Ph(       tnecs_W *w, tnecs_Pi    pi);
 static int tnecs_grow_byA(      tnecs_W *w, size_t      A_id);
+static int tnecs_grow_subA(     tnecs_W *w, size_t      A_id,
+                                size_t   subA_id);
+static int tnecs_reserve_E(     tnecs_W *w, size_t      len);
+static int tnecs_grow_Es(       tnecs_W *w, size_t      olen,
+                                size_t   nlen);
+static int tnecs_grow_Es_aux(   tnecs_W *w, size_t      olen,
+                                size_t   nlen);
+static int tnecs_open_bits(     tnecs_W *w);
+static tnecs_E tnecs_E_handle(  const tnecs_W *w, size_t idx);
+static tnecs_E _tnecs_E_add_C(  tnecs_W *w, tnecs_E E,
+                                tnecs_C  a, int     isNew,
+                                int      init);
+static int tnecs_E_del(         tnecs_W *w, tnecs_E E);
+static int tnecs_room(          const tnecs_W *w, tnecs_C A);
+static int tnecs_room_E(        const tnecs_W *w);
+static int tnecs_idle_fits(     const tnecs_W *w, size_t start,
+                                size_t   bytes,   size_t cost);
+static size_t tnecs_byA_cost(   const tnecs_W *w, size_t tID,
+                                size_t   len);
+static int tnecs_reject(        tnecs_W *w);
+static int tnecs_high(          const tnecs_W *w, size_t num,
+                                size_t   len);
+static int tnecs_reserve_open(  tnecs_W *w, size_t      len);
+static int tnecs_reserve_byA(   tnecs_W *w, size_t      A_id,
+                                size_t   len);
+
+/* --- COMMANDS --- */
+static int tnecs_cmd_push(      tnecs_W *w, int         op,
+                                tnecs_E  E, tnecs_C     A,
+                                const void *Cs);
+static size_t tnecs_cmd_bytes(   const tnecs_W *w, tnecs_C   A,
+                                const void    *Cs);
+static int tnecs_cmds_rec(      tnecs_Cmds    *cmds, const tnecs_W *w,
+                                size_t S_id,  int       op,
+                                tnecs_E E,    tnecs_C   A,
+                                const void    *Cs);
+static int tnecs_cmds_grow(     tnecs_Cmds    *cmds, void **ptr,
+                                size_t olen,  size_t    nlen,
+                                size_t bytesize);
+static int tnecs_cmd_cmp(       const void *a, const void *b);
+static int tnecs_C_set(         tnecs_W *w, tnecs_E     E,
+                                tnecs_C  A, const tnecs_byte *Cs);
+static int tnecs_cmds_create(   tnecs_W *w, const tnecs_Cmd *cmds,
+                                size_t   num, size_t *done);
+static int tnecs_cmd_apply(     tnecs_W *w, const tnecs_Cmd *cmd);
+static int tnecs_cmds_drop(     tnecs_Cmds *cmds, size_t done);
+
+/* --- SNAPSHOTS --- */
+static size_t tnecs_save_align(  size_t pos);
+static int tnecs_save_pad(       FILE *f,       size_t *pos);
+static int tnecs_save_section(   FILE *f,       size_t *pos,
+                                 const void *ptr, size_t bytes);
+static int tnecs_load_at(        FILE *f,   long base,
+                                 unsigned long long off,
+                                 void *dst, size_t bytes,
+                                 size_t *end);
+static int tnecs_load_meta(      tnecs_W **w,
+                                 const unsigned long long *hdr,
+                                 const tnecs_Config *config,
+                                 const tnecs_Alloc  *alloc);
+static int tnecs_load_A(         tnecs_W *w, size_t tID,
+                                 const unsigned long long *A_hdr);
+static int tnecs_mapped(         const tnecs_W *w, const void *ptr);
+
+/* --- DELTAS --- */
+static void tnecs_write_u(       FILE *f, unsigned long long u);
+static int tnecs_read_u(         FILE *f, unsigned long long *u);
+static int tnecs_delta_row(      FILE *f, const tnecs_byte *now,
+                                 const tnecs_byte *old, size_t bytesize);
+static const tnecs_byte *tnecs_delta_base(const tnecs_W *base,
+                                          tnecs_E E, size_t C_id);
+static int tnecs_E_claim(        tnecs_W *w, tnecs_E E);
+static int tnecs_C_zero(         tnecs_W *w, tnecs_E E, tnecs_C A);
+
+/* --- CLONES --- */
+static void *tnecs_dup(          tnecs_W *w, const void *src,
+                                 size_t num, size_t len,
+                                 size_t bytesize);
+static int tnecs_C_own(          tnecs_W *w, tnecs_C_arr *C_arr,
+                                 size_t bytesize);
+static int tnecs_clone_Ss(       tnecs_W *w, tnecs_Ss  *Ss);
+static int tnecs_clone_Pis(      tnecs_W *w, tnecs_Pis *Pis);
+static int tnecs_clone_As(       tnecs_W *w, tnecs_W *clone, int cow);
+static int _tnecs_W_clone(       tnecs_W *w, tnecs_W **out,  int cow);
+#ifdef TNECS_MMAP
+static int tnecs_map_read(       const tnecs_byte **cur,
+                                 void *dst, size_t bytes);
+static void tnecs_unmap(         tnecs_W *w);
+#endif /* TNECS_MMAP */
 static int tnecs_grow_Es_open(  tnecs_W *w);
-static int tnecs_grow_S_byPh(   tnecs_Phs   *byPh,
+static int tnecs_grow_S_byPh(   tnecs_W     *w,
+                                tnecs_Phs   *byPh,
                                 tnecs_Ph     Ph);
 static int tnecs_grow_C_array(  tnecs_W     *w, 
                                 tnecs_C_arr  *C_arr, 
@@ -119,50 +352,100 @@ static int tnecs_C_migrate( tnecs_W *w,     tnecs_E ent,
 
 /************* W FUNCTIONS ***************/
 int tnecs_genesis(tnecs_W **W) {
+    return (tnecs_genesis_alloc(W, NULL));
+}
+
+int tnecs_genesis_alloc(tnecs_W **W, const tnecs_Alloc *alloc) {
+    return (tnecs_genesis_config(W, NULL, alloc));
+}
+
+int tnecs_genesis_config(tnecs_W **W, const tnecs_Config *config,
+                         const tnecs_Alloc *alloc) {
     if (*W != NULL) 
         TNECS_CHECK(tnecs_finale(W));
 
-    *W = calloc(1, sizeof(tnecs_W));
+    /* Unset config: defaults */
+    tnecs_Config conf = {0};
+    if (config != NULL)
+        conf = *config;
+    TNECS_CHECK((conf.grow == 0.0) || (conf.grow > 1.0));
+    TNECS_CHECK((conf.high >= 0.0) && (conf.high <= 1.0));
+    conf.len_Es     = TNECS_OR(conf.len_Es,     TNECS_E_0LEN);
+    conf.len_byA    = TNECS_OR(conf.len_byA,    TNECS_E_0LEN);
+    conf.len_C      = TNECS_OR(conf.len_C,      TNECS_C_0LEN);
+    conf.len_As     = TNECS_OR(conf.len_As,     TNECS_A_0LEN);
+    conf.len_Ss     = TNECS_OR(conf.len_Ss,     TNECS_S_0LEN);
+    conf.grow       = TNECS_OR(conf.grow,       TNECS_ARR_GROW);
+    conf.high       = TNECS_OR(conf.high,       TNECS_HIGH);
+
+    /* All W allocations go through alloc, or stdlib if NULL */
+    tnecs_Alloc std = {tnecs_std_alloc, NULL, tnecs_std_free, NULL};
+    if (alloc == NULL)
+        alloc = &std;
+    TNECS_CHECK((alloc->alloc != NULL) && (alloc->free != NULL));
+    *W = alloc->alloc(alloc->ctx, sizeof(tnecs_W));
     TNECS_CHECK(*W);
+    (*W)->alloc     = *alloc;
+    (*W)->config    = conf;
+    (*W)->cmds.alloc = *alloc;
 
     /* Allocate W members */
-    TNECS_CHECK(_tnecs_breath_Ss(   &((*W)->Ss)));
-    TNECS_CHECK(_tnecs_breath_Es(   &((*W)->Es)));
-    TNECS_CHECK(_tnecs_breath_Pis(  &((*W)->Pis)));
-    TNECS_CHECK(_tnecs_breath_As(   &((*W)->byA)));
-    TNECS_CHECK(_tnecs_breath_C(    &((*W)->Cs)));
+    TNECS_CHECK(_tnecs_breath_Ss(   *W, &((*W)->Ss)));
+    TNECS_CHECK(_tnecs_breath_Es(   *W, &((*W)->Es)));
+    TNECS_CHECK(_tnecs_breath_Pis(  *W, &((*W)->Pis)));
+    TNECS_CHECK(_tnecs_breath_As(   *W, &((*W)->byA)));
+    TNECS_CHECK(_tnecs_breath_C(    *W, &((*W)->Cs)));
+    TNECS_CHECK(_tnecs_breath_Plan( *W, &((*W)->plan)));
+#ifdef TNECS_TRACE
+    (*W)->trace.len = TNECS_TRACE_LEN;
+    (*W)->trace.evs = tnecs_calloc(*W, TNECS_TRACE_LEN, sizeof(tnecs_Ev));
+    TNECS_CHECK((*W)->trace.evs);
+#endif /* TNECS_TRACE */
     return (1);
 }
 
 int tnecs_finale(tnecs_W **W) {
-    TNECS_CHECK(_tnecs_finale_Pis( &((*W)->Pis)));
-    TNECS_CHECK(_tnecs_finale_Ss(  &((*W)->Ss)));
-    TNECS_CHECK(_tnecs_finale_Es(  &((*W)->Es)));
-    TNECS_CHECK(_tnecs_finale_As(  &((*W)->byA)));
-    free(*W);
-
+#ifdef TNECS_MMAP
+    tnecs_unmap(*W);
+#endif /* TNECS_MMAP */
+    TNECS_CHECK(_tnecs_finale_Pis( *W, &((*W)->Pis)));
+    TNECS_CHECK(_tnecs_finale_Ss(  *W, &((*W)->Ss)));
+    TNECS_CHECK(_tnecs_finale_Es(  *W, &((*W)->Es)));
+    TNECS_CHECK(_tnecs_finale_As(  *W, &((*W)->byA)));
+    TNECS_CHECK(_tnecs_finale_Plan(*W, &((*W)->plan)));
+    tnecs_free(*W, (*W)->trace.evs, (*W)->trace.len * sizeof(tnecs_Ev));
+    tnecs_free(*W, (*W)->cmds.arr,  (*W)->cmds.len * sizeof(tnecs_Cmd));
+    tnecs_free(*W, (*W)->cmds.bytes, (*W)->cmds.len_bytes);
+
+    /* W frees itself last */
+    tnecs_Alloc alloc = (*W)->alloc;
+    alloc.free(alloc.ctx, *W, sizeof(tnecs_W));
     *W = NULL;
     return (1);
 }
 
-int _tnecs_breath_C(tnecs_Cs *Cs) {
+int _tnecs_breath_C(tnecs_W *W, tnecs_Cs *Cs) {
+    (void)W;
     Cs->num                   = TNECS_NULLSHIFT;
     Cs->bytesizes[TNECS_NULL] = TNECS_NULL;
     return (1);
 }
 
-int _tnecs_breath_Es(tnecs_Es *Es) {
+int _tnecs_breath_Es(tnecs_W *W, tnecs_Es *Es) {
     /* Variables */
     Es->num         = TNECS_NULLSHIFT;
-    Es->len         = TNECS_E_0LEN;
-    Es->open.len    = TNECS_E_0LEN;
+    Es->len         = W->config.len_Es;
+    Es->open.len    = W->config.len_Es;
     Es->open.num    = 0;
 
     /* Allocs */
-    Es->id          = calloc(Es->len, sizeof(*Es->id));
-    Es->Os          = calloc(Es->len, sizeof(*Es->Os));
-    Es->open.arr    = calloc(Es->len, sizeof(tnecs_E));
-    Es->As          = calloc(Es->len, sizeof(*Es->As));
+    Es->id          = tnecs_calloc(W, Es->len, sizeof(*Es->id));
+    Es->Os          = tnecs_calloc(W, Es->len, sizeof(*Es->Os));
+    Es->open.arr    = tnecs_calloc(W, Es->len, sizeof(tnecs_E));
+    Es->As          = tnecs_calloc(W, Es->len, sizeof(*Es->As));
+    Es->isOpen      = tnecs_calloc(W, TNECS_BITS_LEN(Es->len),
+                                   sizeof(*Es->isOpen));
+    TNECS_CHECK(Es->isOpen);
     TNECS_CHECK(Es->id);
     TNECS_CHECK(Es->Os);
     TNECS_CHECK(Es->open.arr);
@@ -170,66 +453,66 @@ int _tnecs_breath_Es(tnecs_Es *Es) {
     return (1);
 }
 
-int _tnecs_breath_Pis(tnecs_Pis *Pis) {
+int _tnecs_breath_Pis(tnecs_W *W, tnecs_Pis *Pis) {
     Pis->len  = TNECS_Pi_0LEN;
     Pis->num  = TNECS_NULLSHIFT;
 
-    Pis->byPh = calloc(Pis->len, sizeof(*Pis->byPh));
+    Pis->byPh = tnecs_calloc(W, Pis->len, sizeof(*Pis->byPh));
     TNECS_CHECK(Pis->byPh);
-    _tnecs_breath_Phs(&Pis->byPh[TNECS_NULL]);
+    _tnecs_breath_Phs(W, &Pis->byPh[TNECS_NULL]);
     return (1);
 }
 
-int _tnecs_breath_Phs(tnecs_Phs *byPh) {
+int _tnecs_breath_Phs(tnecs_W *W, tnecs_Phs *byPh) {
     byPh->len = TNECS_Ph_0LEN;
     byPh->num = TNECS_NULLSHIFT;
 
-    byPh->Ss        = calloc(byPh->len, sizeof(*byPh->Ss));
-    byPh->Ss_id     = calloc(byPh->len, sizeof(*byPh->Ss_id));
-    byPh->num_Ss    = calloc(byPh->len, sizeof(*byPh->num_Ss));
-    byPh->len_Ss    = calloc(byPh->len, sizeof(*byPh->len_Ss));
+    byPh->Ss        = tnecs_calloc(W, byPh->len, sizeof(*byPh->Ss));
+    byPh->Ss_id     = tnecs_calloc(W, byPh->len, sizeof(*byPh->Ss_id));
+    byPh->num_Ss    = tnecs_calloc(W, byPh->len, sizeof(*byPh->num_Ss));
+    byPh->len_Ss    = tnecs_calloc(W, byPh->len, sizeof(*byPh->len_Ss));
     TNECS_CHECK(byPh->Ss);
     TNECS_CHECK(byPh->Ss_id);
     TNECS_CHECK(byPh->num_Ss);
     TNECS_CHECK(byPh->len_Ss);
-
-    /* Alloc & check for Es_byPh elements */
-    for (size_t i = 0; i < byPh->len; i++) {
-        byPh->Ss[i]     = calloc(byPh->len, sizeof(**byPh->Ss));
-        byPh->Ss_id[i]  = calloc(byPh->len, sizeof(**byPh->Ss_id));
-        TNECS_CHECK(byPh->Ss[i]);
-        TNECS_CHECK(byPh->Ss_id[i]);
-
-        byPh->num_Ss[i] = 0;
-        byPh->len_Ss[i] = byPh->len;
-    }
+    /* Ss of each phase on first system */
     return (1);
 }
 
-int _tnecs_breath_Ss(tnecs_Ss *Ss) {
+int _tnecs_breath_Ss(tnecs_W *W, tnecs_Ss *Ss) {
     /* Variables */
-    Ss->len        = TNECS_S_0LEN;
+    Ss->len        = W->config.len_Ss;
     Ss->num        = TNECS_NULLSHIFT;
 #ifndef NDEBUG
-    Ss->to_run.len = TNECS_S_0LEN;
-    Ss->ran.len    = TNECS_S_0LEN;
+    Ss->to_run.len = W->config.len_Ss;
+    Ss->ran.len    = W->config.len_Ss;
 #endif /* NDEBUG */
 
     /* Allocs */
-    Ss->Phs = calloc(Ss->len, sizeof(*Ss->Phs));
-    Ss->Os  = calloc(Ss->len, sizeof(*Ss->Os));
-    Ss->Pi  = calloc(Ss->len, sizeof(*Ss->Pi));
-    Ss->Ex  = calloc(Ss->len, sizeof(*Ss->Ex));
-    Ss->As  = calloc(Ss->len, sizeof(*Ss->As));
+    Ss->Phs = tnecs_calloc(W, Ss->len, sizeof(*Ss->Phs));
+    Ss->Os  = tnecs_calloc(W, Ss->len, sizeof(*Ss->Os));
+    Ss->Pi  = tnecs_calloc(W, Ss->len, sizeof(*Ss->Pi));
+    Ss->Ex  = tnecs_calloc(W, Ss->len, sizeof(*Ss->Ex));
+    Ss->As  = tnecs_calloc(W, Ss->len, sizeof(*Ss->As));
+    Ss->batch    = tnecs_calloc(W, Ss->len, sizeof(*Ss->batch));
+    Ss->plan_O   = tnecs_calloc(W, Ss->len, sizeof(*Ss->plan_O));
+    Ss->plan_num = tnecs_calloc(W, Ss->len, sizeof(*Ss->plan_num));
 #ifndef NDEBUG
-    Ss->ran.arr     = calloc(Ss->ran.len,    sizeof(tnecs_S_f));
-    Ss->to_run.arr  = calloc(Ss->to_run.len, sizeof(tnecs_S_f));
+    Ss->ran.arr     = tnecs_calloc(W, Ss->ran.len,    sizeof(tnecs_S_f));
+    Ss->to_run.arr  = tnecs_calloc(W, Ss->to_run.len, sizeof(tnecs_S_f));
 #endif /* NDEBUG */
     TNECS_CHECK(Ss->Phs);
     TNECS_CHECK(Ss->Os);
     TNECS_CHECK(Ss->Pi);
     TNECS_CHECK(Ss->Ex);
     TNECS_CHECK(Ss->As);
+    TNECS_CHECK(Ss->batch);
+    TNECS_CHECK(Ss->plan_O);
+    TNECS_CHECK(Ss->plan_num);
+#ifdef TNECS_PROFILE
+    Ss->prof = tnecs_calloc(W, Ss->len, sizeof(*Ss->prof));
+    TNECS_CHECK(Ss->prof);
+#endif /* TNECS_PROFILE */
 #ifndef NDEBUG
     TNECS_CHECK(Ss->ran.arr);
     TNECS_CHECK(Ss->to_run.arr);
@@ -238,118 +521,128 @@ int _tnecs_breath_Ss(tnecs_Ss *Ss) {
     return (1);
 }
 
-int _tnecs_breath_As(tnecs_As *byA) {
+int _tnecs_breath_As(tnecs_W *W, tnecs_As *byA) {
     /* Variables */
     byA->num = TNECS_NULLSHIFT;
-    byA->len = TNECS_A_0LEN;
+    byA->len = W->config.len_As;
 
-    /* Allocs */
-    byA->A          = calloc(byA->len, sizeof(*byA->A));
-    byA->Es         = calloc(byA->len, sizeof(*byA->Es));
-    byA->Cs         = calloc(byA->len, sizeof(*byA->Cs));
-    byA->len_Es     = calloc(byA->len, sizeof(*byA->len_Es));
-    byA->num_Es     = calloc(byA->len, sizeof(*byA->num_Es));
-    byA->subA       = calloc(byA->len, sizeof(*byA->subA));
-    byA->Cs_id      = calloc(byA->len, sizeof(*byA->Cs_id));
-    byA->num_Cs     = calloc(byA->len, sizeof(*byA->num_Cs));
-    byA->Cs_O       = calloc(byA->len, sizeof(*byA->Cs_O));
-    byA->num_A_ids  = calloc(byA->len, sizeof(*byA->num_A_ids));
-    TNECS_CHECK(byA->A);
-    TNECS_CHECK(byA->Es);
-    TNECS_CHECK(byA->Cs);
-    TNECS_CHECK(byA->subA);
-    TNECS_CHECK(byA->len_Es);
-    TNECS_CHECK(byA->num_Es);
-    TNECS_CHECK(byA->Cs_id);
-    TNECS_CHECK(byA->num_Cs);
-    TNECS_CHECK(byA->Cs_O);
-    TNECS_CHECK(byA->num_A_ids);
-
-    /* Alloc & check for id_byA elements */
-    for (size_t i = 0; i < byA->len; i++) {
-        byA->subA[i] = calloc(TNECS_C_CAP, sizeof(**byA->subA));
-        byA->Es[i]   = calloc(TNECS_E_0LEN, sizeof(**byA->Es));
-        TNECS_CHECK(byA->subA[i]);
-        TNECS_CHECK(byA->Es[i]);
+    /* Allocs: Es & subA of each slot on first use */
+    byA->arr = tnecs_calloc(W, byA->len, sizeof(*byA->arr));
+    TNECS_CHECK(byA->arr);
+    return (1);
+}
 
-        byA->num_Es[i] = 0;
-        byA->len_Es[i] = TNECS_E_0LEN;
-    }
+int _tnecs_breath_Plan(tnecs_W *W, tnecs_Plan *plan) {
+    /* Variables */
+    plan->num   = 0;
+    plan->len   = W->config.len_Ss;
+    plan->dirty = 1;
+
+    /* Allocs */
+    plan->Ss    = tnecs_calloc(W, plan->len, sizeof(*plan->Ss));
+    plan->Ss_id = tnecs_calloc(W, plan->len, sizeof(*plan->Ss_id));
+    plan->tables = tnecs_calloc(W, plan->len, sizeof(*plan->tables));
+    plan->Cs.num = 0;
+    plan->Cs.len = W->config.len_Ss;
+    plan->Cs.arr = tnecs_calloc(W, plan->Cs.len, sizeof(void *));
+    TNECS_CHECK(plan->Ss);
+    TNECS_CHECK(plan->Ss_id);
+    TNECS_CHECK(plan->tables);
+    TNECS_CHECK(plan->Cs.arr);
     return (1);
 }
 
-static int _tnecs_finale_Phs(tnecs_Phs *byPh) {
+static int _tnecs_finale_Phs(tnecs_W *W, tnecs_Phs *byPh) {
     if(byPh == NULL) {
         return(1);
     }
 
     for (size_t i = 0; i < byPh->len; i++) {
         if (byPh->Ss != NULL) {
-            free(byPh->Ss[i]);
+            tnecs_free(W, byPh->Ss[i],
+                       byPh->len_Ss[i] * sizeof(**byPh->Ss));
             byPh->Ss[i] = NULL;
         }
         if (byPh->Ss_id != NULL) {
-            free(byPh->Ss_id[i]);
+            tnecs_free(W, byPh->Ss_id[i],
+                       byPh->len_Ss[i] * sizeof(**byPh->Ss_id));
             byPh->Ss_id[i] = NULL;
         }
     }
 
     if (byPh->Ss != NULL) {
-        free(byPh->Ss);
+        tnecs_free(W, byPh->Ss, byPh->len * sizeof(*byPh->Ss));
         byPh->Ss        = NULL;
     }
 
     if (byPh->Ss_id != NULL) {
-        free(byPh->Ss_id);
+        tnecs_free(W, byPh->Ss_id, byPh->len * sizeof(*byPh->Ss_id));
         byPh->Ss_id     = NULL;
     }
 
     if (byPh->len_Ss != NULL) {
-        free(byPh->len_Ss);
+        tnecs_free(W, byPh->len_Ss, byPh->len * sizeof(*byPh->len_Ss));
         byPh->len_Ss    = NULL;
     }
     
     if (byPh->num_Ss != NULL) {
-        free(byPh->num_Ss);
+        tnecs_free(W, byPh->num_Ss, byPh->len * sizeof(*byPh->num_Ss));
         byPh->num_Ss    = NULL;
     }
 
     return(1);
 }
 
-static int _tnecs_finale_Ss(tnecs_Ss *Ss) {
+static int _tnecs_finale_Ss(tnecs_W *W, tnecs_Ss *Ss) {
     if(Ss == NULL) {
         return(1);
     }
 
+    size_t len = Ss->len;
     if (Ss->Os != NULL) {
-        free(Ss->Os);
+        tnecs_free(W, Ss->Os,       len * sizeof(*Ss->Os));
         Ss->Os  = NULL;
     }
     if (Ss->Phs != NULL) {
-        free(Ss->Phs);
+        tnecs_free(W, Ss->Phs,      len * sizeof(*Ss->Phs));
         Ss->Phs = NULL;
     }
     if (Ss->Pi != NULL) {
-        free(Ss->Pi);
+        tnecs_free(W, Ss->Pi,       len * sizeof(*Ss->Pi));
         Ss->Pi  = NULL;
     }
     if (Ss->Ex != NULL) {
-        free(Ss->Ex);
+        tnecs_free(W, Ss->Ex,       len * sizeof(*Ss->Ex));
         Ss->Ex  = NULL;
     }
     if (Ss->As != NULL) {
-        free(Ss->As);
+        tnecs_free(W, Ss->As,       len * sizeof(*Ss->As));
         Ss->As  = NULL;
     }
+    if (Ss->batch != NULL) {
+        tnecs_free(W, Ss->batch,    len * sizeof(*Ss->batch));
+        Ss->batch       = NULL;
+    }
+    if (Ss->plan_O != NULL) {
+        tnecs_free(W, Ss->plan_O,   len * sizeof(*Ss->plan_O));
+        Ss->plan_O      = NULL;
+    }
+    if (Ss->plan_num != NULL) {
+        tnecs_free(W, Ss->plan_num, len * sizeof(*Ss->plan_num));
+        Ss->plan_num    = NULL;
+    }
+    if (Ss->prof != NULL) {
+        tnecs_free(W, Ss->prof,     len * sizeof(*Ss->prof));
+        Ss->prof        = NULL;
+    }
 
     #ifndef NDEBUG
     if (Ss->to_run.arr != NULL) {
-        free(Ss->to_run.arr);
+        tnecs_free(W, Ss->to_run.arr, Ss->to_run.len * sizeof(tnecs_S_f));
         Ss->to_run.arr  = NULL;
     }
     if (Ss->ran.arr != NULL) {
-        free(Ss->ran.arr);
+        tnecs_free(W, Ss->ran.arr,    Ss->ran.len * sizeof(tnecs_S_f));
         Ss->ran.arr     = NULL;
     }
     #endif /* NDEBUG */
@@ -357,256 +650,475 @@ static int _tnecs_finale_Ss(tnecs_Ss *Ss) {
     return(1);
 }
 
-static int _tnecs_finale_Es(tnecs_Es *Es) {
+static int _tnecs_finale_Es(tnecs_W *W, tnecs_Es *Es) {
     if(Es == NULL) {
         return(1);
     }
     if (Es->id != NULL) {
-        free(Es->id);
+        tnecs_free(W, Es->id,       Es->len * sizeof(*Es->id));
         Es->id          = NULL;
     }
     if (Es->Os != NULL) {
-        free(Es->Os);
+        tnecs_free(W, Es->Os,       Es->len * sizeof(*Es->Os));
         Es->Os          = NULL;
     }
     if (Es->open.arr != NULL) {
-        free(Es->open.arr);
+        tnecs_free(W, Es->open.arr, Es->open.len * sizeof(tnecs_E));
         Es->open.arr    = NULL;
     }
     if (Es->As != NULL) {
-        free(Es->As);
+        tnecs_free(W, Es->As,       Es->len * sizeof(*Es->As));
         Es->As          = NULL;
     }
+    tnecs_free(W, Es->gen,    Es->len * sizeof(*Es->gen));
+    tnecs_free(W, Es->isOpen, TNECS_BITS_LEN(Es->len) * sizeof(*Es->isOpen));
+    Es->gen         = NULL;
+    Es->isOpen      = NULL;
     
     return(1);
 }
 
-static int _tnecs_finale_Pis(tnecs_Pis *Pis) {
+static int _tnecs_finale_Pis(tnecs_W *W, tnecs_Pis *Pis) {
     if (Pis == NULL) {
         return(1);
     }
     for (size_t i = 0; i < Pis->len; i++) {
-        _tnecs_finale_Phs(&Pis->byPh[i]);
+        _tnecs_finale_Phs(W, &Pis->byPh[i]);
     }
     if (Pis->byPh != NULL) {
-        free(Pis->byPh);
+        tnecs_free(W, Pis->byPh, Pis->len * sizeof(*Pis->byPh));
         Pis->byPh = NULL;
     }
     
     return(1);
 }
 
-static int _tnecs_finale_As(tnecs_As *byA) {
+static int _tnecs_finale_As(tnecs_W *W, tnecs_As *byA) {
+    if (byA->arr == NULL)
+        return (1);
     for (size_t i = 0; i < byA->len; i++) {
-        if (byA->Es != NULL) {
-            free(byA->Es[i]);
-            byA->Es[i] = NULL;
-        }
-        if (byA->Cs_id != NULL) {
-            free(byA->Cs_id[i]);
-            byA->Cs_id[i] = NULL;
-        }
-        if (byA->Cs_O != NULL) {
-            free(byA->Cs_O[i]);
-            byA->Cs_O[i] = NULL;
-        }
-        if (byA->subA != NULL) {
-            free(byA->subA[i]);
-            byA->subA[i] = NULL;
-        }
-        if (byA->Cs != NULL) {
-            for (size_t j = 0; j < byA->num_Cs[i]; j++) {
-                free(byA->Cs[i][j].Cs);
-                byA->Cs[i][j].Cs = NULL;
+        tnecs_Arch *arch = &byA->arr[i];
+        tnecs_free(W, arch->Es,   arch->len_Es    * sizeof(*arch->Es));
+        tnecs_free(W, arch->subA, arch->len_A_ids * sizeof(*arch->subA));
+        for (size_t j = 0; j < arch->num_Cs; j++) {
+            tnecs_C_arr *C_arr = &arch->Cs[j];
+            size_t bytesize = W->Cs.bytesizes[arch->Cs_id[j]];
+            /* Shared columns: last owner frees */
+            if ((C_arr->refs == NULL) || (--*C_arr->refs == 0)) {
+                tnecs_free(W, C_arr->Cs, C_arr->len * bytesize);
+                tnecs_free(W, C_arr->refs, sizeof(*C_arr->refs));
             }
-            free(byA->Cs[i]);
-            byA->Cs[i] = NULL;
         }
+        tnecs_free(W, arch->Cs, arch->num_Cs * TNECS_ARCH_C_BYTES);
     }
+    tnecs_free(W, byA->arr, byA->len * sizeof(*byA->arr));
+    byA->arr = NULL;
+    return (1);
+}
 
-    if (byA->A != NULL) {
-        free(byA->A);
-        byA->A          = NULL;
-    }
-    if (byA->Es != NULL) {
-        free(byA->Es);
-        byA->Es         = NULL;
-    }
-    if (byA->Cs != NULL) {
-        free(byA->Cs);
-        byA->Cs         = NULL;
-    }
-    if (byA->len_Es != NULL) {
-        free(byA->len_Es);
-        byA->len_Es     = NULL;
-    }
-    if (byA->num_Es != NULL) {
-        free(byA->num_Es);
-        byA->num_Es     = NULL;
-    }
-    if (byA->subA != NULL) {
-        free(byA->subA);
-        byA->subA       = NULL;
+static int _tnecs_finale_Plan(tnecs_W *W, tnecs_Plan *plan) {
+    if (plan == NULL) {
+        return(1);
     }
-    if (byA->Cs_id != NULL) {
-        free(byA->Cs_id);
-        byA->Cs_id      = NULL;
+    if (plan->Ss != NULL) {
+        tnecs_free(W, plan->Ss,     plan->len * sizeof(*plan->Ss));
+        plan->Ss    = NULL;
     }
-    if (byA->num_Cs != NULL) {
-        free(byA->num_Cs);
-        byA->num_Cs     = NULL;
+    if (plan->Ss_id != NULL) {
+        tnecs_free(W, plan->Ss_id,  plan->len * sizeof(*plan->Ss_id));
+        plan->Ss_id = NULL;
     }
-    if (byA->Cs_O != NULL) {
-        free(byA->Cs_O);
-        byA->Cs_O       = NULL;
+    if (plan->tables != NULL) {
+        tnecs_free(W, plan->tables, plan->len * sizeof(*plan->tables));
+        plan->tables = NULL;
     }
-    if (byA->num_A_ids != NULL) {
-        free(byA->num_A_ids);
-        byA->num_A_ids  = NULL;
+    if (plan->Cs.arr != NULL) {
+        tnecs_free(W, plan->Cs.arr, plan->Cs.len * sizeof(void *));
+        plan->Cs.arr = NULL;
     }
-    
+
     return(1);
 }
 
 /********************* STEPPING ********************/
 int tnecs_step(tnecs_W *W, tnecs_ns dt, void *data) {
+    TNECS_REC(W, TNECS_REC_STEP, dt);
+    TNECS_TRACE_B(W, TNECS_TRACE_STEP, 0, 0);
     for (size_t p = 0; p < W->Pis.num; p++) {
         TNECS_CHECK(tnecs_step_Pi(W, dt, data, p));
     }
+    TNECS_TRACE_E(W, TNECS_TRACE_STEP, 0, 0);
     return (1);
 }
 
 int tnecs_step_Pi(  tnecs_W     *w,     tnecs_ns     dt,
                     void        *data,  tnecs_Pi     pi) {
-    #ifndef NDEBUG
-    w->Ss.to_run.num   = 0;
-    w->Ss.ran.num      = 0;
-    #endif /* NDEBUG */
-
     tnecs_Phs *byPh = TNECS_Pi_GET(w, pi);
-    for (size_t ph = 0; ph < byPh->num; ph++) {
-        TNECS_CHECK(tnecs_step_Pi_Ph(w, dt, data, pi, ph));
-    }
-    return(1);
+    TNECS_TRACE_B(w, TNECS_TRACE_Pi, pi, 0);
+    TNECS_CHECK(tnecs_plan_walk(w, dt, data, pi, 0, byPh->num));
+    TNECS_TRACE_E(w, TNECS_TRACE_Pi, pi, 0);
+    return (1);
 }
 
 int tnecs_step_Pi_Ph(   tnecs_W  *w,    tnecs_ns  dt,
                         void     *data, tnecs_Pi  pi,
                         tnecs_Ph  ph) {
-    tnecs_Phs *byPh = TNECS_Pi_GET(w, pi);
-    size_t num = byPh->num_Ss[ph];
-    for (size_t S_O = 0; S_O < num; S_O++) {
-        size_t S_id = byPh->Ss_id[ph][S_O];
-        TNECS_CHECK(tnecs_S_run(w, S_id, dt, data));
-    }
-
-    return(1);
+    return (tnecs_plan_walk(w, dt, data, pi, ph, ph + 1));
 }
 
-/************* SYSTEM FUNCTIONS ***************/
-int tnecs_custom_S_run( tnecs_W     *W, tnecs_S_f    S,
-                        tnecs_C      A, tnecs_ns     dt, 
-                        void        *data) {
-    /* Building the Ss input */
-    tnecs_In input = {.world = W, .dt = dt, .data = data};
-    size_t A_id = tnecs_A_id(W, A);
-    if (A_id == TNECS_NULL) {
-        printf("tnecs: Input archetype is unknown.\n");
-        return (0);
+/****************** EXECUTION PLAN *****************/
+int tnecs_plan_build(tnecs_W *W) {
+    /* Flatten every (system, archetype) pair, in stepping
+    ** order: pipeline, phase, system order, archetype. */
+    /* 1- Count pairs, columns */
+    size_t num = 0, num_Cs = 0;
+    for (size_t Pi = 0; Pi < W->Pis.num; Pi++) {
+        tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
+        for (size_t Ph = 0; Ph < byPh->num; Ph++) {
+            for (size_t S_O = 0; S_O < byPh->num_Ss[Ph]; S_O++) {
+                size_t S_id     = byPh->Ss_id[Ph][S_O];
+                size_t A_id     = tnecs_A_id(W, W->Ss.As[S_id]);
+                size_t num_S    = 1;
+                if (!W->Ss.Ex[S_id])
+                    num_S += W->byA.arr[A_id].num_A_ids;
+                num     += num_S;
+                num_Cs  += num_S * W->byA.arr[A_id].num_Cs;
+            }
+        }
     }
+    if (num >= W->plan.len)
+        TNECS_CHECK(tnecs_grow_plan(W, num + 1));
+    if (num_Cs >= W->plan.Cs.len) {
+        size_t olen = W->plan.Cs.len;
+        size_t nlen = tnecs_grow_len(W, olen, num_Cs + 1);
+        void **arr  = tnecs_realloc(W, W->plan.Cs.arr, olen, nlen,
+                                    sizeof(void *));
+        TNECS_CHECK(arr);
+        W->plan.Cs.arr = arr;
+        W->plan.Cs.len = nlen;
+    }
+
+    /* 2- Fill pairs */
+    tnecs_Plan *plan    = &W->plan;
+    void **Cs           = plan->Cs.arr;
+    plan->num           = 0;
+    plan->Cs.num        = 0;
+    for (size_t Pi = 0; Pi < W->Pis.num; Pi++) {
+        tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
+        for (size_t Ph = 0; Ph < byPh->num; Ph++) {
+            for (size_t S_O = 0; S_O < byPh->num_Ss[Ph]; S_O++) {
+                size_t S_id     = byPh->Ss_id[Ph][S_O];
+                tnecs_S_f S     = byPh->Ss[Ph][S_O];
+                size_t A_id     = tnecs_A_id(W, W->Ss.As[S_id]);
+                size_t num_subA = W->Ss.Ex[S_id] ? 0 :
+                                  W->byA.arr[A_id].num_A_ids;
+
+                W->Ss.plan_O[S_id]      = plan->num;
+                W->Ss.plan_num[S_id]    = 1 + num_subA;
+
+                /* Exclusive archetype first, then subarchetypes */
+                for (size_t subA_O = 0; subA_O <= num_subA; subA_O++) {
+                    tnecs_Table *table  = &plan->tables[plan->num];
+                    table->A_id         = (subA_O == 0) ? A_id :
+                                          W->byA.arr[A_id].subA[subA_O - 1];
+                    table->Cs           = Cs + plan->Cs.num;
+                    plan->Ss[plan->num]     = S;
+                    plan->Ss_id[plan->num]  = S_id;
+                    plan->Cs.num           += W->byA.arr[A_id].num_Cs;
+                    plan->num++;
+                }
+            }
+        }
+    }
+    assert(plan->num    == num);
+    assert(plan->Cs.num == num_Cs);
+    plan->dirty = 0;
+    return (tnecs_plan_resolve(W));
+}
 
-    /* Running the exclusive custom system */
-    input.E_A_id = A_id;
-    input.num_Es = W->byA.num_Es[input.E_A_id];
-    S(&input);
-
-    /* Running the non-exclusive/inclusive custom system */
-    size_t num_subA = W->byA.num_A_ids[A_id];
-    for (size_t subA_O = 0; subA_O < num_subA; subA_O++) {
-        input.E_A_id = W->byA.subA[A_id][subA_O];
-        input.num_Es = W->byA.num_Es[input.E_A_id];
-        S(&input);
+int tnecs_plan_resolve(tnecs_W *W) {
+    /* Resolve column pointers of all pairs.
+    ** Columns move only when growing. */
+    tnecs_Plan *plan = &W->plan;
+    for (size_t plan_O = 0; plan_O < plan->num; plan_O++) {
+        size_t S_id         = plan->Ss_id[plan_O];
+        tnecs_Table *table  = &plan->tables[plan_O];
+        size_t A_id         = table->A_id;
+        /* First pair of system is its own archetype */
+        size_t S_A_id       = plan->tables[W->Ss.plan_O[S_id]].A_id;
+
+        table->Es = W->byA.arr[A_id].Es;
+        for (size_t C_O = 0; C_O < W->byA.arr[S_A_id].num_Cs; C_O++) {
+            size_t C_id     = W->byA.arr[S_A_id].Cs_id[C_O];
+            size_t C_O_byA  = W->byA.arr[A_id].Cs_O[C_id];
+            tnecs_C_arr *C_arr = &W->byA.arr[A_id].Cs[C_O_byA];
+            TNECS_CHECK(tnecs_C_own(W, C_arr, W->Cs.bytesizes[C_id]));
+            table->Cs[C_O]  = C_arr->Cs;
+        }
     }
+    plan->stale = 0;
     return (1);
 }
 
-int tnecs_S_run(tnecs_W *W, size_t S_id,
-                tnecs_ns dt, void *data) {
-    /* Building the Ss input */
-    tnecs_In input  = {.world = W, .dt = dt, .data = data};
-    size_t S_O      = W->Ss.Os[S_id];
-    tnecs_Ph Ph     = W->Ss.Phs[S_id];
-    tnecs_Pi Pi     = W->Ss.Pi[S_id];
-    size_t S_A_id   = tnecs_A_id(W, W->Ss.As[S_id]);
+void tnecs_plan_range(  const tnecs_W *const W,
+                        tnecs_Pi Pi,    tnecs_Ph Ph0,
+                        tnecs_Ph Ph1,   size_t  *start,
+                        size_t  *end) {
+    /* Phases are contiguous in plan: [first S of Ph0, last S of Ph1[ */
+    const tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
+    int found   = 0;
+    *start      = 0;
+    *end        = 0;
+    for (size_t Ph = Ph0; Ph < Ph1; Ph++) {
+        size_t num = byPh->num_Ss[Ph];
+        if (num == 0)
+            continue;
 
-    input.E_A_id    = S_A_id;
-    input.num_Es    = W->byA.num_Es[input.E_A_id];
-    tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
+        size_t first    = byPh->Ss_id[Ph][0];
+        size_t last     = byPh->Ss_id[Ph][num - 1];
+        if (!found) {
+            *start  = W->Ss.plan_O[first];
+            found   = 1;
+        }
+        *end = W->Ss.plan_O[last] + W->Ss.plan_num[last];
+    }
+}
+
+size_t tnecs_plan_run(tnecs_W *W, tnecs_In *input, size_t plan_O) {
+    /* Run system on one (system, archetype) pair, or on all
+    ** pairs at once if batch system. Outputs next plan_O. */
+    size_t S_id         = W->plan.Ss_id[plan_O];
+    tnecs_S_f S         = W->plan.Ss[plan_O];
+    tnecs_Table *tables = &W->plan.tables[plan_O];
+    size_t num_tables   = 1;
+    if (W->Ss.batch[S_id])
+        num_tables = W->Ss.plan_O[S_id] + W->Ss.plan_num[S_id] - plan_O;
+
+    input->S_id         = S_id;
+    input->S_A          = W->Ss.As[S_id];
+    input->num_Es       = 0;
+    input->tables       = tables;
+    input->num_tables   = num_tables;
+    size_t num_full     = 0;
+    for (size_t table_O = 0; table_O < num_tables; table_O++) {
+        size_t A_id             = tables[table_O].A_id;
+        tables[table_O].num_Es  = W->byA.arr[A_id].num_Es;
+        input->num_Es          += tables[table_O].num_Es;
+        num_full               += (tables[table_O].num_Es > 0);
+    }
+    input->E_A_id       = tables->A_id;
+    input->Es           = tables->Es;
+    input->Cs           = tables->Cs;
 
-    tnecs_S_f S = byPh->Ss[Ph][S_O];
 #ifndef NDEBUG
     while (W->Ss.to_run.num >= (W->Ss.to_run.len - 1)) {
+        if (W->locked)
+            return (tnecs_reject(W));
         TNECS_CHECK(tnecs_grow_ran(W));
     }
-
-    tnecs_S_f *S_arr;
-    size_t S_num;
-    S_num           = W->Ss.to_run.num++;
-    S_arr           = W->Ss.to_run.arr;
-    S_arr[S_num]    = S;
+    tnecs_S_f *S_arr                = W->Ss.to_run.arr;
+    S_arr[W->Ss.to_run.num++]       = S;
 #endif /* NDEBUG */
 
-    /* - Running the exclusive Ss in current phase - */
-    if (input.num_Es > 0) {
-        /* Skip running system if no Es! */
-    #ifndef NDEBUG
-        S_num           = W->Ss.ran.num++;
-        S_arr           = W->Ss.ran.arr;
-        S_arr[S_num]    = S;
-    #endif /* NDEBUG */
-        S(&input);
+    size_t next = plan_O + num_tables;
+#ifdef TNECS_PROFILE
+    tnecs_S_prof *prof  = &W->Ss.prof[S_id];
+    size_t first        = W->Ss.plan_O[S_id];
+    size_t last         = first + W->Ss.plan_num[S_id];
+    if (plan_O == first) {
+        prof->run       = 0;
+        prof->run_calls = 0;
     }
+#endif /* TNECS_PROFILE */
 
-    if (W->Ss.Ex[S_id])
-        return (1);
+    /* Skip running system if no Es! */
+    if (input->num_Es > 0) {
+#ifndef NDEBUG
+        S_arr                       = W->Ss.ran.arr;
+        S_arr[W->Ss.ran.num++]      = S;
+#endif /* NDEBUG */
 
-    /* - Running the inclusive Ss in current phase - */
-    size_t num_subA = W->byA.num_A_ids[S_A_id];
-    for (size_t subA_O = 0; subA_O < num_subA; subA_O++) {
-        input.E_A_id    = W->byA.subA[S_A_id][subA_O];
-        input.num_Es    = W->byA.num_Es[input.E_A_id];
-        tnecs_S_f S     = byPh->Ss[Ph][S_O];
+        TNECS_TRACE_B(W, TNECS_TRACE_S, S_id, input->E_A_id);
+#ifdef TNECS_PROFILE
+        tnecs_ns t0 = TNECS_NOW();
+        W->cmds.S_id = S_id;
+        S(input);
+        W->cmds.S_id = TNECS_NULL;
+        prof->run += TNECS_NOW() - t0;
+        prof->calls++;
+        prof->run_calls++;
+        prof->num_As += num_full;
+        prof->num_Es += input->num_Es;
+#else
+        W->cmds.S_id = S_id;
+        S(input);
+        W->cmds.S_id = TNECS_NULL;
+#endif /* TNECS_PROFILE */
+        TNECS_TRACE_E(W, TNECS_TRACE_S, S_id, input->E_A_id);
+    }
+
+#ifdef TNECS_PROFILE
+    /* Last pair of system: run is done. No calls: no run */
+    if ((next == last) && (prof->run_calls > 0)) {
+        prof->min = ((prof->runs == 0) || (prof->run < prof->min)) ?
+                    prof->run : prof->min;
+        prof->max = (prof->run > prof->max) ? prof->run : prof->max;
+        prof->total += prof->run;
+        prof->runs++;
+    }
+#endif /* TNECS_PROFILE */
+    return (next);
+}
 
-    #ifndef NDEBUG
-        S_num           = W->Ss.to_run.num++;
-        S_arr           = W->Ss.to_run.arr;
-        S_arr[S_num]    = S;
+int tnecs_plan_walk(tnecs_W *W,     tnecs_ns dt,
+                    void    *data,  tnecs_Pi Pi,
+                    tnecs_Ph Ph0,   tnecs_Ph Ph1) {
+    if (W->plan.dirty)
+        TNECS_CHECK(tnecs_plan_build(W));
+    if (W->plan.stale)
+        TNECS_CHECK(tnecs_plan_resolve(W));
+#ifndef NDEBUG
+    /* Each walk records its own systems */
+    W->Ss.to_run.num    = 0;
+    W->Ss.ran.num       = 0;
+#endif /* NDEBUG */
 
-        while (W->Ss.to_run.num >= (W->Ss.to_run.len - 1)) {
-            TNECS_CHECK(tnecs_grow_ran(W));
+    size_t plan_O, end;
+    tnecs_plan_range(W, Pi, Ph0, Ph1, &plan_O, &end);
+
+    tnecs_In input = {.world = W, .dt = dt, .data = data};
+#ifdef TNECS_TRACE
+    int      in_Ph  = 0;
+    tnecs_Ph Ph     = 0;
+#endif /* TNECS_TRACE */
+    while (plan_O < end) {
+        size_t S_id = W->plan.Ss_id[plan_O];
+#ifdef TNECS_TRACE
+        if (!in_Ph || (Ph != W->Ss.Phs[S_id])) {
+            if (in_Ph)
+                TNECS_TRACE_E(W, TNECS_TRACE_Ph, Ph, Pi);
+            Ph      = W->Ss.Phs[S_id];
+            in_Ph   = 1;
+            TNECS_TRACE_B(W, TNECS_TRACE_Ph, Ph, Pi);
         }
-    #endif /* NDEBUG */
+#endif /* TNECS_TRACE */
+        size_t next = tnecs_plan_run(W, &input, plan_O);
+        TNECS_CHECK(next);
+
+        /* Phase done: apply commands, resume at next phase */
+        tnecs_Ph S_Ph = W->Ss.Phs[S_id];
+        if ((W->cmds.num > 0) && ((next >= end) ||
+            (W->Ss.Phs[W->plan.Ss_id[next]] != S_Ph))) {
+            TNECS_CHECK(tnecs_cmds_apply(W));
+            if (W->plan.dirty)
+                TNECS_CHECK(tnecs_plan_build(W));
+            else if (W->plan.stale)
+                TNECS_CHECK(tnecs_plan_resolve(W));
+            tnecs_plan_range(W, Pi, S_Ph + 1, Ph1, &plan_O, &end);
+            continue;
+        }
+
+        if (W->plan.stale && !W->plan.dirty)
+            TNECS_CHECK(tnecs_plan_resolve(W));
 
-        if (input.num_Es <= 0) {
+        if (!W->plan.dirty) {
+            plan_O = next;
             continue;
         }
 
-        #ifndef NDEBUG
-            S_num           = W->Ss.ran.num++;
-            S_arr           = W->Ss.ran.arr;
-            S_arr[S_num]    = S;
-        #endif /* NDEBUG */
+        /* System changed structure: rebuild,
+        ** resume after pairs ran of current system. */
+        size_t pair_O = next - W->Ss.plan_O[S_id];
+        TNECS_CHECK(tnecs_plan_build(W));
+        tnecs_plan_range(W, Pi, Ph0, Ph1, &plan_O, &end);
+        plan_O = W->Ss.plan_O[S_id] + pair_O;
+    }
+#ifdef TNECS_TRACE
+    if (in_Ph)
+        TNECS_TRACE_E(W, TNECS_TRACE_Ph, Ph, Pi);
+#endif /* TNECS_TRACE */
+
+    return(1);
+}
+
+/************* SYSTEM FUNCTIONS ***************/
+int tnecs_custom_S_run( tnecs_W     *W, tnecs_S_f    S,
+                        tnecs_C      A, tnecs_ns     dt, 
+                        void        *data) {
+    /* Building the Ss input */
+    tnecs_In input = {.world = W, .dt = dt, .data = data};
+    size_t A_id = tnecs_A_id(W, A);
+    if (A_id == TNECS_NULL) {
+        printf("tnecs: Input archetype is unknown.\n");
+        return (0);
+    }
 
+    /* Exclusive custom system first, then inclusive */
+    void *Cs[TNECS_C_CAP];
+    tnecs_Table table   = {.Cs = Cs};
+    input.S_A           = A;
+    input.Cs            = Cs;
+    input.tables        = &table;
+    input.num_tables    = 1;
+    size_t num_subA     = W->byA.arr[A_id].num_A_ids;
+    for (size_t subA_O = 0; subA_O <= num_subA; subA_O++) {
+        table.A_id      = (subA_O == 0) ? A_id :
+                          W->byA.arr[A_id].subA[subA_O - 1];
+        table.num_Es    = W->byA.arr[table.A_id].num_Es;
+        table.Es        = W->byA.arr[table.A_id].Es;
+        for (size_t C_O = 0; C_O < W->byA.arr[A_id].num_Cs; C_O++) {
+            size_t C_id = W->byA.arr[A_id].Cs_id[C_O];
+            Cs[C_O] = tnecs_C_array(W, C_id, table.A_id);
+        }
+        input.E_A_id    = table.A_id;
+        input.num_Es    = table.num_Es;
+        input.Es        = table.Es;
         S(&input);
     }
     return (1);
 }
 
+int tnecs_S_run(tnecs_W *W, size_t S_id,
+                tnecs_ns dt, void *data) {
+    if (W->plan.dirty)
+        TNECS_CHECK(tnecs_plan_build(W));
+    if (W->plan.stale)
+        TNECS_CHECK(tnecs_plan_resolve(W));
+
+    /* Building the Ss input */
+    tnecs_In input  = {.world = W, .dt = dt, .data = data};
+
+    /* - Exclusive archetype, then inclusive subarchetypes - */
+    size_t pair_O = 0;
+    while (pair_O < W->Ss.plan_num[S_id]) {
+        size_t plan_O   = W->Ss.plan_O[S_id] + pair_O;
+        size_t next     = tnecs_plan_run(W, &input, plan_O);
+        TNECS_CHECK(next);
+        pair_O         += next - plan_O;
+
+        if (W->plan.dirty)
+            TNECS_CHECK(tnecs_plan_build(W));
+        else if (W->plan.stale)
+            TNECS_CHECK(tnecs_plan_resolve(W));
+    }
+    return (1);
+}
+
 /*************** REGISTRATION ***************/
 size_t tnecs_register_S(tnecs_W     *W,     tnecs_S_f  S,
                         tnecs_Pi     Pi,    tnecs_Ph   Ph,
                         int          isEx,  size_t     num_Cs,
                         tnecs_C      A) {
+    if (W->locked)
+        return (tnecs_reject(W));
+    TNECS_REC(W, TNECS_REC_REGISTER_S, Pi, Ph, isEx, num_Cs, A);
+    return (_tnecs_register_S(W, S, Pi, Ph, isEx, num_Cs, A));
+}
+
+size_t _tnecs_register_S(   tnecs_W     *W,     tnecs_S_f  S,
+                            tnecs_Pi     Pi,    tnecs_Ph   Ph,
+                            int          isEx,  size_t     num_Cs,
+                            tnecs_C      A) {
     /* Check if phase exist */
     if (!TNECS_Pi_VALID(W, Pi)) {
         printf("tnecs: System pipeline '%lld' is invalid.\n", Pi);
@@ -628,7 +1140,7 @@ size_t tnecs_register_S(tnecs_W     *W,     tnecs_S_f  S,
     /* Realloc Ss_byPh if too many */
     tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
     if (byPh->num_Ss[Ph] >= byPh->len_Ss[Ph]) {
-        TNECS_CHECK(tnecs_grow_S_byPh(byPh, Ph));
+        TNECS_CHECK(tnecs_grow_S_byPh(W, byPh, Ph));
     }
 
     /* -- Actual registration -- */
@@ -644,6 +1156,23 @@ size_t tnecs_register_S(tnecs_W     *W,     tnecs_S_f  S,
     byPh->Ss[Ph][S_O]       = S;
     byPh->Ss_id[Ph][S_O]    = S_id;
     TNECS_CHECK(_tnecs_register_A(W, num_Cs, A));
+    W->plan.dirty           = 1;
+    return (S_id);
+}
+
+size_t tnecs_register_S_batch(  tnecs_W     *W,     tnecs_S_f  S,
+                                tnecs_Pi     Pi,    tnecs_Ph   Ph,
+                                size_t       num_Cs,
+                                tnecs_C      A) {
+    if (W->locked)
+        return (tnecs_reject(W));
+    TNECS_REC(W, TNECS_REC_REGISTER_S_BATCH, Pi, Ph, num_Cs, A);
+    size_t S_id = _tnecs_register_S(W, S, Pi, Ph, 0, num_Cs, A);
+    if (S_id == TNECS_NULL)
+        return (TNECS_NULL);
+
+    W->Ss.batch[S_id]   = 1;
+    W->plan.dirty       = 1;
     return (S_id);
 }
 
@@ -651,6 +1180,9 @@ tnecs_C tnecs_register_C(   tnecs_W     *W,
                             size_t       bytesize,
                             tnecs_free_f finit,
                             tnecs_free_f ffree) {
+    if (W->locked)
+        return (tnecs_reject(W));
+    TNECS_REC(W, TNECS_REC_REGISTER_C, bytesize);
     /* Checks */
     if (bytesize <= 0) {
         printf("tnecs: Component should have >0 bytesize.\n");
@@ -675,76 +1207,61 @@ size_t _tnecs_register_A(   tnecs_W    *W, size_t      num_Cs,
                             tnecs_C     A_new) {
     /* 0- Check if archetype exists, return */
     for (size_t i = 0 ; i < W->byA.num; i++) {
-        if (A_new == W->byA.A[i]) {
+        if (A_new == W->byA.arr[i].A) {
             return (i);
         }
     }
 
     /* 1- Add new byA.Cs at [tID] */
+    TNECS_TRACE_B(W, TNECS_TRACE_REGISTER_A, W->byA.num, A_new);
     if ((W->byA.num + 1) >= W->byA.len)
         TNECS_CHECK(tnecs_grow_A(W));
-    W->byA.A[W->byA.num++] = A_new;
+    W->byA.arr[W->byA.num++].A = A_new;
     size_t tID = tnecs_A_id(W, A_new);
     assert(tID == (W->byA.num - 1));
-    W->byA.num_Cs[tID] = num_Cs;
+    W->byA.arr[tID].num_Cs = num_Cs;
 
-    /* 2- Add arrays to byA.Cs[tID] for each component */
+    /* 2- Add columns, Cs_id & Cs_O to byA.arr[tID] */
     TNECS_CHECK(tnecs_C_arr_new(W, num_Cs, A_new));
 
-    /* 3- Add all Cs to byA.Cs_id */
-    tnecs_C A_reduced   = A_new, A_added = 0;
-    size_t bytesize1    = sizeof(**W->byA.Cs_id);
-    size_t bytesize2    = sizeof(**W->byA.Cs_O);
-    W->byA.Cs_id[tID]   = calloc(num_Cs,      bytesize1);
-    W->byA.Cs_O[tID]    = calloc(TNECS_C_CAP, bytesize2);
-    TNECS_CHECK(W->byA.Cs_id[tID]);
-    TNECS_CHECK(W->byA.Cs_O[tID]);
-
-    size_t C_O_byA = 0;
-    while (A_reduced) {
-        A_reduced &= (A_reduced - 1);
-
-        tnecs_C C_T_toadd = (A_reduced + A_added) ^ A_new;
-        A_added += C_T_toadd;
-        assert(C_T_toadd > 0);
-        tnecs_C C_id_toadd = TNECS_C_T2ID(C_T_toadd);
-
-        W->byA.Cs_id[tID][C_O_byA]      = C_id_toadd;
-        W->byA.Cs_O[tID][C_id_toadd]    = C_O_byA++;
-    }
-
-    /* 4- Find every subtype of every archertype. 
-    **  a. Check if ALL archetypes are subtypes
-    **  b. If subtype: to list of subtypes byA.subA */
-    for (size_t i = 1; i < W->byA.num; i++) {
-        W->byA.num_A_ids[i] = 0;
-        for (size_t j = 1; j < W->byA.num; j++) {
-            if (i == j)
-                continue;
-
-            if (!TNECS_A_IS_subA(W->byA.A[i], W->byA.A[j]))
-                continue;
+    /* 4- Find subtypes of & with new archetype only.
+    **  - Other pairs unchanged since their registration
+    **  - tID is highest: subA stays in increasing A_id */
+    W->byA.arr[tID].num_A_ids = 0;
+    for (size_t j = 1; j < tID; j++) {
+        /* j is an archetype of tID */
+        if (TNECS_A_IS_subA(A_new, W->byA.arr[j].A))
+            TNECS_CHECK(tnecs_grow_subA(W, tID, j));
 
-            /* j is an archetype of i */
-            W->byA.subA[i][W->byA.num_A_ids[i]++] = j;
-        }
+        /* tID is an archetype of j */
+        if (TNECS_A_IS_subA(W->byA.arr[j].A, A_new))
+            TNECS_CHECK(tnecs_grow_subA(W, j, tID));
     }
 
+    /* 5- New subarchetypes: systems run on more archetypes */
+    W->plan.dirty = 1;
+    TNECS_TRACE_E(W, TNECS_TRACE_REGISTER_A, tID, A_new);
     return (tID);
 }
 
 size_t tnecs_register_Pi(tnecs_W *W) {
+    if (W->locked)
+        return (tnecs_reject(W));
     tnecs_Pi Pi = W->Pis.num++;
     while (Pi >= W->Pis.len) {
         TNECS_CHECK(tnecs_grow_Pi(W));
     }
     tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
-    _tnecs_breath_Phs(byPh);
+    TNECS_CHECK(_tnecs_breath_Phs(W, byPh));
 
+    TNECS_REC(W, TNECS_REC_REGISTER_Pi, Pi);
     return (Pi);
 }
 
 size_t tnecs_register_Ph(tnecs_W *W, tnecs_Pi Pi) {
+    if (W->locked)
+        return (tnecs_reject(W));
+    TNECS_REC(W, TNECS_REC_REGISTER_Ph, Pi);
     if (!TNECS_Pi_VALID(W, Pi)) {
         printf("tnecs: Pi '%lld' is invalid for new phase.\n", Pi);
         return (TNECS_NULL);
@@ -760,6 +1277,9 @@ size_t tnecs_register_Ph(tnecs_W *W, tnecs_Pi Pi) {
 
 /**************** ENTITY MANIPULATION **************/
 tnecs_E tnecs_E_create(tnecs_W *W) {
+    assert(W->rsv.cap == 0);
+    if (W->locked && !(tnecs_room_E(W) && tnecs_room(W, TNECS_NULL)))
+        return (tnecs_reject(W));
     tnecs_E out = TNECS_NULL;
 
     /* Check if an open entity exists */
@@ -770,6 +1290,7 @@ tnecs_E tnecs_E_create(tnecs_W *W) {
           ) {
         out = arr[--W->Es.open.num];
         arr[W->Es.open.num] = TNECS_NULL;
+        TNECS_BIT_CLR(W->Es.isOpen, out);
     }
 
     /* If no open entity existed, create one */
@@ -782,15 +1303,17 @@ tnecs_E tnecs_E_create(tnecs_W *W) {
                 }
             }
             out = W->Es.num++;
-        } while (TNECS_E_EXISTS(W, out));
+        } while (W->Es.id[out] != TNECS_NULL);
     }
     assert(out != TNECS_NULL);
 
     /* Set entity and checks  */
-    W->Es.id[out] = out;
+    out = tnecs_E_handle(W, out);
+    W->Es.id[TNECS_E_IDX(W, out)] = out;
     TNECS_CHECK(tnecs_EsbyA_add(W, out, TNECS_NULL));
-    assert(W->Es.id[out]                                          == out);
-    assert(W->byA.Es[TNECS_NULL][W->Es.Os[out]]  == out);
+    assert(W->Es.id[TNECS_E_IDX(W, out)]                                          == out);
+    assert(W->byA.arr[TNECS_NULL].Es[W->Es.Os[TNECS_E_IDX(W, out)]]  == out);
+    TNECS_REC(W, TNECS_REC_CREATE, out);
     return (out);
 }
 
@@ -804,6 +1327,8 @@ tnecs_E tnecs_E_create_wC(tnecs_W *W, size_t argnum, ...) {
         A += TNECS_C_ID2T(C_id);
     }
     va_end(ap);
+    if (W->locked && !(tnecs_room_E(W) && tnecs_room(W, A)))
+        return (tnecs_reject(W));
 
     /* Create entity with all Cs */
     tnecs_E new_E = tnecs_E_create(W);
@@ -815,9 +1340,9 @@ tnecs_E tnecs_E_create_wC(tnecs_W *W, size_t argnum, ...) {
 
 #ifndef NDEBUG
     size_t tID      = tnecs_A_id(W, A);
-    size_t order    = W->Es.Os[new_E];
-    assert(W->byA.Es[tID][order]    == new_E);
-    assert(W->Es.id[new_E]          == new_E);
+    size_t order    = W->Es.Os[TNECS_E_IDX(W, new_E)];
+    assert(W->byA.arr[tID].Es[order]    == new_E);
+    assert(W->Es.id[TNECS_E_IDX(W, new_E)]          == new_E);
 #endif /* NDEBUG */
 
     return (new_E);
@@ -825,16 +1350,26 @@ tnecs_E tnecs_E_create_wC(tnecs_W *W, size_t argnum, ...) {
 
 int tnecs_E_open_find(tnecs_W *W) {
     /* Adds all null Es to open list */
+    if (W->locked) {
+        /* Locked: all found Es must fit without growth */
+        size_t found = 0;
+        for (tnecs_E i = TNECS_NULLSHIFT; i < W->Es.num; i++)
+            found += (W->Es.id[i] == TNECS_NULL) &&
+                     !TNECS_BIT_GET(W->Es.isOpen, i);
+        if ((found > 0) && ((W->Es.open.num + found) >= W->Es.open.len))
+            return (tnecs_reject(W));
+    }
     for (tnecs_E i = TNECS_NULLSHIFT; i < W->Es.num; i++) {
-        if (TNECS_E_EXISTS(W, i))
+        if (W->Es.id[i] != TNECS_NULL)
             continue; /* Skip if entity exists */
 
-        if (tnecs_E_isOpen(W, i))
+        if (TNECS_BIT_GET(W->Es.isOpen, i))
             continue; /* Skip if already in open list */
 
         TNECS_CHECK(tnecs_grow_Es_open(W));
         tnecs_E *arr = W->Es.open.arr;
         arr[W->Es.open.num++] = i;
+        TNECS_BIT_SET(W->Es.isOpen, i);
     }
     return (1);
 };
@@ -842,175 +1377,1544 @@ int tnecs_E_open_find(tnecs_W *W) {
 int tnecs_E_open_flush(tnecs_W *W) {
     /* Get rid of all Es in Es_open */
     W->Es.open.num = 0;
-    return (1);
+    return (tnecs_open_bits(W));
 }
 
 tnecs_E tnecs_E_isOpen(tnecs_W *W, tnecs_E E) {
-    if (E <= TNECS_NULL) {
+    size_t idx = TNECS_E_IDX(W, E);
+    if ((idx <= TNECS_NULL) || (idx >= W->Es.len)) {
         return (0);
     }
-
-    const tnecs_E * const open_arr = W->Es.open.arr;
-
-    for (tnecs_E i = TNECS_NULLSHIFT; i < W->Es.open.num; i++) {
-        if (open_arr[i] == E) {
-            return (1);
-        }
-    }
-    return (0);
+    return (TNECS_BIT_GET(W->Es.isOpen, idx));
 }
 
 tnecs_E tnecs_E_destroy(tnecs_W *W, tnecs_E E) {
+    assert(W->rsv.cap == 0);
+    if (W->locked && W->reuse_Es &&
+        ((W->Es.open.num + 1) >= W->Es.open.len))
+        return (tnecs_reject(W));
+    TNECS_REC(W, TNECS_REC_DESTROY, E);
+    return (tnecs_E_del(W, E));
+}
+
+int tnecs_E_del(tnecs_W *W, tnecs_E E) {
+    /* Destroy without growth: locked & open list full, E is
+    ** left out of open list, for tnecs_E_open_find */
     if (E <= TNECS_NULL) {
         return (1);
     }
 
     if (!TNECS_E_EXISTS(W, E)) {
-        W->Es.id[E] = TNECS_NULL;
-        W->Es.Os[E] = TNECS_NULL;
-        W->Es.As[E] = TNECS_NULL;
+        /* Stale handle: slot may be another E, untouched */
         return (1);
     }
 
     /* Preliminaries */
-    tnecs_C A = W->Es.As[E];
+    tnecs_C A = W->Es.As[TNECS_E_IDX(W, E)];
 
     /* Delete Cs */
     TNECS_CHECK(tnecs_C_free(W, E, A));
     TNECS_CHECK(tnecs_C_del(W, E, A));
 
 #ifndef NDEBUG
-    size_t E_O = W->Es.Os[E];
+    size_t E_O = W->Es.Os[TNECS_E_IDX(W, E)];
     size_t tID = tnecs_A_id(W, A);
-    assert(W->byA.num_Es[tID] > TNECS_NULL);
-    assert(W->byA.len_Es[tID] >= E_O);
-    assert(W->byA.num_Es[tID] > TNECS_NULL);
+    assert(W->byA.arr[tID].num_Es > TNECS_NULL);
+    assert(W->byA.arr[tID].len_Es >= E_O);
+    assert(W->byA.arr[tID].num_Es > TNECS_NULL);
 #endif /* NDEBUG */
 
     /* Delete EsbyA */
     TNECS_CHECK(tnecs_EsbyA_del(W, E, A));
 
-    /* Delete entity */
-    W->Es.id[E] = TNECS_NULL;
+    /* Delete entity, stale handles */
+    size_t idx = TNECS_E_IDX(W, E);
+    W->Es.id[idx] = TNECS_NULL;
+    if (W->gen_Es)
+        W->Es.gen[idx] = (W->Es.gen[idx] + 1) & 0xFFFFFFFFULL;
 
     /* Note: reuse_Es used to add to Es_open, so that
     ** user can call tnecs_E_open_find to reuse Es manually. */
-    if (W->reuse_Es) {
+    if (W->reuse_Es && (!W->locked ||
+                        ((W->Es.open.num + 1) < W->Es.open.len))) {
         /* Add deleted entity to open Es */
         TNECS_CHECK(tnecs_grow_Es_open(W));
         tnecs_E *arr = W->Es.open.arr;
-        arr[W->Es.open.num++] = E;
+        arr[W->Es.open.num++] = idx;
+        TNECS_BIT_SET(W->Es.isOpen, idx);
     }
     assert(!TNECS_E_EXISTS(W, E));
-    assert(W->Es.Os[E]      == TNECS_NULL);
-    assert(W->Es.As[E]      == TNECS_NULL);
-    assert(W->Es.Os[E_O]    != E);
+    assert(W->Es.Os[TNECS_E_IDX(W, E)]      == TNECS_NULL);
+    assert(W->Es.As[TNECS_E_IDX(W, E)]      == TNECS_NULL);
+    assert(W->Es.Os[TNECS_E_IDX(W, E_O)]    != E);
     return (1);
 }
 
 void tnecs_W_reuse_E(tnecs_W *W, int toggle) {
+    TNECS_REC(W, TNECS_REC_REUSE_E, toggle);
     W->reuse_Es = toggle;
 }
 
-/*****************************************************/
-/***************** TNECS INTERNALS *******************/
-/*****************************************************/
-tnecs_E tnecs_E_add_C(  tnecs_W *W,         tnecs_E  E,
-                        tnecs_C  A_toadd,   int      isNew) {
-    if (A_toadd <= 0) {
-        return (TNECS_NULL);
-    }
+int tnecs_W_gen_E(tnecs_W *W, int toggle) {
+    /* Generations of live Es from handles, dead Es start at 0.
+    ** Off: handles are indices, live Es must have generation 0 */
+    for (size_t idx = 0; !toggle && (idx < W->Es.num); idx++)
+        TNECS_CHECK(TNECS_E_GEN(W->Es.id[idx]) == 0);
+    TNECS_REC(W, TNECS_REC_GEN_E, toggle);
+    if (toggle && (W->Es.gen == NULL)) {
+        W->Es.gen = tnecs_calloc(W, W->Es.len, sizeof(*W->Es.gen));
+        TNECS_CHECK(W->Es.gen);
+    }
+    for (size_t idx = 0; toggle && (idx < W->Es.num); idx++) {
+        if (W->Es.id[idx] != TNECS_NULL)
+            W->Es.gen[idx] = TNECS_E_GEN(W->Es.id[idx]);
+    }
+    W->gen_Es = toggle;
+    return (1);
+}
 
-    if (!TNECS_E_EXISTS(W, E)) {
-        return (TNECS_NULL);
+tnecs_E tnecs_E_handle(const tnecs_W *W, size_t idx) {
+    /* Next handle of index */
+    if (!W->gen_Es)
+        return (idx);
+    return (idx | ((tnecs_E)W->Es.gen[idx] << 32));
+}
+
+int tnecs_open_bits(tnecs_W *W) {
+    /* Membership from open list */
+    const tnecs_E *arr = W->Es.open.arr;
+    memset(W->Es.isOpen, 0, TNECS_BITS_LEN(W->Es.len) * sizeof(*W->Es.isOpen));
+    for (size_t i = 0; i < W->Es.open.num; i++) {
+        TNECS_CHECK((arr[i] > TNECS_NULL) && (arr[i] < W->Es.len));
+        TNECS_BIT_SET(W->Es.isOpen, arr[i]);
     }
+    return (1);
+}
 
-    tnecs_C A_old = W->Es.As[E];
+int tnecs_W_ids(tnecs_W *W, size_t num) {
+    /* Room for num reserved ids, table grown now */
+    TNECS_CHECK(W->rsv.cap == 0);
+    TNECS_CHECK(tnecs_reserve_E(W, W->Es.num + num + 1));
+    TNECS_STORE(&W->rsv.open, W->Es.open.num);
+    TNECS_STORE(&W->rsv.next, W->Es.num);
+    W->rsv.cap = W->Es.num + num;
+    return (1);
+}
 
-    if (TNECS_A_HAS_T(A_toadd, A_old)) {
-        return (E);
+tnecs_E tnecs_E_reserve(tnecs_W *W) {
+    /* Pop open list: arr untouched until sync */
+    size_t top = TNECS_LOAD(&W->rsv.open);
+    while (top > 0) {
+        if (TNECS_CAS(&W->rsv.open, &top, top - 1))
+            return (tnecs_E_handle(W, ((tnecs_E *)W->Es.open.arr)[top - 1]));
     }
+    return (tnecs_E_reserve_n(W, 1));
+}
 
-    tnecs_C A_new = A_toadd + A_old;
-    assert(A_new != A_old);
-    if (isNew)
-        TNECS_CHECK(_tnecs_register_A(  W, setBits_KnR(A_new), 
-                                        A_new));
+tnecs_E tnecs_E_reserve_n(tnecs_W *W, size_t num) {
+    /* Bump, never past cap. Never used: generation 0 */
+    size_t next = TNECS_LOAD(&W->rsv.next);
+    while ((num > 0) && ((next + num) <= W->rsv.cap)) {
+        if (TNECS_CAS(&W->rsv.next, &next, next + num))
+            return (next);
+    }
+    return (TNECS_NULL);
+}
 
-    TNECS_CHECK(tnecs_C_migrate(    W, E, A_old, A_new));
-    TNECS_CHECK(tnecs_EsbyA_migrate(W, E, A_old, A_new));
-    TNECS_CHECK(tnecs_C_init(       W, E, A_toadd));
+int tnecs_E_sync(tnecs_W *W) {
+    /* Create reserved Es, in tnecs_E_create order */
+    if (W->rsv.cap == 0)
+        return (1);
+    W->rsv.cap  = 0;
+    size_t open = TNECS_LOAD(&W->rsv.open);
+    size_t next = TNECS_LOAD(&W->rsv.next);
+    size_t num  = (W->Es.open.num - open) + (next - W->Es.num);
+    size_t num_Es = W->byA.arr[TNECS_NULL].num_Es;
+    TNECS_CHECK(tnecs_reserve_byA(W, TNECS_NULL, num_Es + num + 1));
+    tnecs_E *arr = W->Es.open.arr;
+    while (W->Es.open.num > open) {
+        tnecs_E E = tnecs_E_handle(W, arr[--W->Es.open.num]);
+        arr[W->Es.open.num] = TNECS_NULL;
+        TNECS_BIT_CLR(W->Es.isOpen, TNECS_E_IDX(W, E));
+        TNECS_CHECK(tnecs_E_claim(W, E));
+        TNECS_REC(W, TNECS_REC_CREATE, E);
+    }
+    for (tnecs_E E = W->Es.num; E < next; E++) {
+        TNECS_CHECK(tnecs_E_claim(W, E));
+        TNECS_REC(W, TNECS_REC_CREATE, E);
+    }
+    return (1);
+}
+
+int tnecs_W_reserve(tnecs_W *W, tnecs_C A, size_t num) {
+    /* Room for num more Es in W & A, without growth.
+    ** Es of A pass through TNECS_NULL archetype when created */
+    TNECS_CHECK(!W->locked);
+    TNECS_CHECK(tnecs_reserve_E(W, W->Es.num + num + 1));
+    TNECS_CHECK(tnecs_reserve_open(W, W->Es.len + 1));
+    size_t tID = TNECS_NULL;
+    if (A != TNECS_NULL)
+        tID = _tnecs_register_A(W, setBits_KnR(A), A);
+    TNECS_CHECK(tID != TNECS_NULL || A == TNECS_NULL);
+    size_t num_Es0 = W->byA.arr[TNECS_NULL].num_Es;
+    TNECS_CHECK(tnecs_reserve_byA(W, TNECS_NULL, num_Es0 + 2 +
+                                  ((tID == TNECS_NULL) ? num : 0)));
+    size_t num_Es = W->byA.arr[tID].num_Es;
+    TNECS_CHECK(tnecs_reserve_byA(W, tID, num_Es + num + 1));
+    return (1);
+}
 
+int tnecs_W_lock(tnecs_W *W, int toggle) {
+    /* Locked: no allocation, ops needing growth rejected.
+    ** Before locking: plan built, columns not shared by clones,
+    ** debug step arrays long enough. */
+    if (toggle && !W->locked) {
+        if (W->plan.dirty)
+            TNECS_CHECK(tnecs_plan_build(W));
+        else if (W->plan.stale)
+            TNECS_CHECK(tnecs_plan_resolve(W));
+        for (size_t tID = 0; tID < W->byA.num; tID++) {
+            tnecs_Arch *arch = &W->byA.arr[tID];
+            for (size_t C_O = 0; C_O < arch->num_Cs; C_O++) {
+                size_t bytesize = W->Cs.bytesizes[arch->Cs_id[C_O]];
+                TNECS_CHECK(tnecs_C_own(W, &arch->Cs[C_O], bytesize));
+            }
+        }
 #ifndef NDEBUG
-    size_t tID_new = tnecs_A_id(W, A_new);
-    size_t new_O = W->byA.num_Es[tID_new] - 1;
-    assert(W->Es.As[E]                  == A_new);
-    assert(W->byA.Es[tID_new][new_O]    == E);
-    assert(W->Es.Os[E]                  == new_O);
+        while (W->Ss.to_run.len < (W->plan.num + 2))
+            TNECS_CHECK(tnecs_grow_ran(W));
 #endif /* NDEBUG */
-    return (W->Es.id[E]);
+    }
+    W->locked = toggle;
+    return (1);
 }
 
-tnecs_E tnecs_E_rm_C(   tnecs_W *W, tnecs_E  E,
-                        tnecs_C  A) {
-    /* Get new archetype. 
-    ** Since it is a archetype, just need to substract. */
-    tnecs_C A_old = W->Es.As[E];
-    tnecs_C A_new = A_old - A;
-
-    /* Free removed Cs. */
-    TNECS_CHECK(tnecs_C_free(W, E, A));
-    if (A_new != TNECS_NULL) {
-        /* Migrate remaining Cs to new A array. */
-        TNECS_CHECK(_tnecs_register_A(  W, setBits_KnR(A_new),
-                                        A_new));
-        TNECS_CHECK(tnecs_C_migrate(W, E, A_old, A_new));
-    } else {
-        /* No remaining component, delete everything. */
-        TNECS_CHECK(tnecs_C_del(W, E, A_old));
+int tnecs_W_idle(tnecs_W *W, size_t bytes) {
+    /* Grow arrays filled above config.high before creates need to,
+    ** until bytes copied. Idle between frames: bounded creates.
+    ** 0 bytes: all arrays. */
+    if (W->locked)
+        return (1);
+    /* Growth copies old arrays: skipped if over budget */
+    size_t start = W->counts.bytes_copied;
+    if (tnecs_high(W, W->Es.num, W->Es.len)) {
+        size_t per_E = sizeof(*W->Es.id) + sizeof(*W->Es.Os) +
+                       sizeof(*W->Es.As) +
+                       ((W->Es.gen != NULL) ? sizeof(*W->Es.gen) : 0);
+        size_t cost  = W->Es.len * per_E +
+                       TNECS_BITS_LEN(W->Es.len) * sizeof(*W->Es.isOpen);
+        size_t len   = tnecs_grow_len(W, W->Es.len, W->Es.len + 1);
+        if (tnecs_idle_fits(W, start, bytes, cost))
+            TNECS_CHECK(tnecs_reserve_E(W, len));
+    }
+    if (W->reuse_Es && tnecs_high(W, W->Es.open.num, W->Es.open.len)) {
+        size_t olen = W->Es.open.len;
+        size_t nlen = tnecs_grow_len(W, olen, olen + 1);
+        if (tnecs_idle_fits(W, start, bytes, olen * sizeof(tnecs_E)))
+            TNECS_CHECK(tnecs_reserve_open(W, nlen));
+    }
+    for (size_t tID = 0; tID < W->byA.num; tID++) {
+        if ((bytes > 0) && ((W->counts.bytes_copied - start) >= bytes))
+            break;
+        /* Shortest of Es & columns, lazy slots stay empty */
+        tnecs_Arch *arch = &W->byA.arr[tID];
+        if (arch->num_Es == 0)
+            continue;
+        size_t len = arch->len_Es;
+        for (size_t C_O = 0; C_O < arch->num_Cs; C_O++) {
+            if (arch->Cs[C_O].len < len)
+                len = arch->Cs[C_O].len;
+        }
+        if (tnecs_high(W, arch->num_Es, len)) {
+            size_t nlen = tnecs_grow_len(W, len, len + 1);
+            size_t cost = tnecs_byA_cost(W, tID, nlen);
+            if (tnecs_idle_fits(W, start, bytes, cost))
+                TNECS_CHECK(tnecs_reserve_byA(W, tID, nlen));
+        }
     }
-    /* Migrate E to new byA array. */
-    TNECS_CHECK(tnecs_EsbyA_migrate(W, E, A_old, A_new));
-    assert(A_new == W->Es.As[E]);
     return (1);
 }
 
-void *tnecs_get_C(  tnecs_W *W, tnecs_E  E,
-                    tnecs_C  C_id) {
-    if (!TNECS_E_EXISTS(W, E))
-        return (NULL);
+int tnecs_idle_fits(const tnecs_W *W, size_t start,
+                    size_t bytes,     size_t cost) {
+    /* Copied since start, plus cost, within bytes. 0: no limit */
+    size_t spent = W->counts.bytes_copied - start;
+    return ((bytes == 0) || ((spent + cost) <= bytes));
+}
 
-    tnecs_C C_flag  = TNECS_C_ID2T(C_id);
-    tnecs_C E_A     = TNECS_E_A(W, E);
-    /* If entity has component, get output it.  */
-    /* If not output NULL. */
-    if (!TNECS_A_HAS_T(C_flag, E_A))
-        return (NULL);
+size_t tnecs_byA_cost(const tnecs_W *W, size_t tID, size_t len) {
+    /* Bytes copied by tnecs_reserve_byA, shared columns included */
+    const tnecs_Arch *arch = &W->byA.arr[tID];
+    size_t cost = 0;
+    if (len > arch->len_Es)
+        cost += arch->len_Es * sizeof(tnecs_E);
+    for (size_t C_O = 0; C_O < arch->num_Cs; C_O++) {
+        const tnecs_C_arr *C_arr = &arch->Cs[C_O];
+        size_t bytesize = W->Cs.bytesizes[arch->Cs_id[C_O]];
+        if (len <= C_arr->len)
+            continue;
+        cost += C_arr->len * bytesize;
+        if ((C_arr->refs != NULL) && (*C_arr->refs > 1))
+            cost += C_arr->num * bytesize;
+    }
+    return (cost);
+}
 
-    size_t tID = tnecs_A_id(W, E_A);
-    assert(tID > 0);
-    size_t C_O = tnecs_C_O_byA(W, C_id, E_A);
-    assert(C_O <= W->byA.num_Cs[tID]);
-    size_t E_O = W->Es.Os[E];
-    size_t bytesize = W->Cs.bytesizes[C_id];
+int tnecs_high(const tnecs_W *W, size_t num, size_t len) {
+    return ((double)num >= ((double)len * W->config.high));
+}
 
-    tnecs_C_arr *C_array = &W->byA.Cs[tID][C_O];
-    assert(C_array != NULL);
-    tnecs_byte *temp_C_bytesptr = (tnecs_byte *)(C_array->Cs);
-    void *out = temp_C_bytesptr + (bytesize * E_O);
+int tnecs_room_E(const tnecs_W *W) {
+    /* One more E fits in Es table without growth */
+    return ((W->Es.open.num > 0) || (W->Es.num < W->Es.len));
+}
+
+int tnecs_room(const tnecs_W *W, tnecs_C A) {
+    /* One more E fits in registered A without growth */
+    size_t tID = tnecs_A_id(W, A);
+    if ((tID == TNECS_NULL) && (A != TNECS_NULL))
+        return (0);
+    const tnecs_Arch *arch = &W->byA.arr[tID];
+    if ((arch->num_Es + 1) >= arch->len_Es)
+        return (0);
+    for (size_t C_O = 0; C_O < arch->num_Cs; C_O++) {
+        if ((arch->Cs[C_O].num + 1) >= arch->Cs[C_O].len)
+            return (0);
+    }
+    return (1);
+}
+
+int tnecs_reject(tnecs_W *W) {
+    W->counts.rejects++;
+    return (0);
+}
+
+/****************** SNAPSHOTS *****************/
+size_t tnecs_save_align(size_t pos) {
+    return ((pos + TNECS_SAVE_ALIGN - 1) / TNECS_SAVE_ALIGN * TNECS_SAVE_ALIGN);
+}
+
+int tnecs_save_pad(FILE *f, size_t *pos) {
+    /* Zeros until pos is aligned */
+    size_t aligned = tnecs_save_align(*pos);
+    for (; *pos < aligned; (*pos)++)
+        TNECS_CHECK(fputc(0, f) != EOF);
+    return (1);
+}
+
+int tnecs_save_section(FILE *f,   size_t *pos,
+                       const void *ptr, size_t bytes) {
+    /* Section at pos, padded to next alignment */
+    const tnecs_byte *arr = ptr;
+    TNECS_CHECK(TNECS_WRITE(f, arr, bytes));
+    *pos += bytes;
+    TNECS_CHECK(tnecs_save_pad(f, pos));
+    return (1);
+}
+
+int tnecs_W_save(const tnecs_W *W, FILE *f) {
+    /* Layout:
+    **  1. Meta: magic, header, Cs bytesizes, open list,
+    **     per archetype: A, num_Cs, num_Es, Es offset,
+    **     Cs_id, columns offsets.
+    **  2. Sections, aligned: Es id, Os, As, gen if any.
+    **     Per archetype: Es, columns.
+    **     Same layout as arrays in memory. */
+    size_t num_Es   = W->Es.num;
+    size_t num_open = W->Es.open.num;
+
+    /* Offsets start after meta */
+    size_t pos = strlen(TNECS_SAVE_MAGIC) +
+                 TNECS_SAVE_HDR * sizeof(unsigned long long) +
+                 W->Cs.num * sizeof(*W->Cs.bytesizes) +
+                 num_open * sizeof(tnecs_E);
+    for (size_t tID = 0; tID < W->byA.num; tID++) {
+        size_t num_Cs = W->byA.arr[tID].num_Cs;
+        pos += 4 * sizeof(unsigned long long) +
+               num_Cs * sizeof(tnecs_C) +
+               num_Cs * sizeof(unsigned long long);
+    }
+    pos = tnecs_save_align(pos);
+
+    unsigned long long hdr[TNECS_SAVE_HDR] = {
+        TNECS_SAVE_VERSION, W->Cs.num,  W->reuse_Es,
+        num_Es,             W->Es.len,  num_open,
+        W->byA.num,         pos,
+        tnecs_save_align(pos + num_Es * sizeof(*W->Es.id)),
+        0,                  W->gen_Es,  0
+    };
+    hdr[9] = tnecs_save_align(hdr[8] + num_Es * sizeof(*W->Es.Os));
+    pos    = tnecs_save_align(hdr[9] + num_Es * sizeof(*W->Es.As));
+    if (W->Es.gen != NULL) {
+        hdr[11] = pos;
+        pos     = tnecs_save_align(pos + num_Es * sizeof(*W->Es.gen));
+    }
+
+    /* 1. Meta. Offsets from base, snapshot start in f */
+    size_t magic_len = strlen(TNECS_SAVE_MAGIC);
+    TNECS_CHECK(f != NULL);
+    long base = ftell(f);
+    TNECS_CHECK(base >= 0);
+    TNECS_CHECK(fwrite(TNECS_SAVE_MAGIC, 1, magic_len, f) == magic_len);
+    TNECS_CHECK(TNECS_WRITE(f, hdr, TNECS_SAVE_HDR));
+    TNECS_CHECK(TNECS_WRITE(f, W->Cs.bytesizes, W->Cs.num));
+    const tnecs_E *open = W->Es.open.arr;
+    TNECS_CHECK(TNECS_WRITE(f, open, num_open));
+    for (size_t tID = 0; tID < W->byA.num; tID++) {
+        size_t A_num_Es = W->byA.arr[tID].num_Es;
+        size_t num_Cs   = W->byA.arr[tID].num_Cs;
+        unsigned long long A_hdr[4] = {
+            W->byA.arr[tID].A, num_Cs, A_num_Es, pos
+        };
+        pos = tnecs_save_align(pos + A_num_Es * sizeof(tnecs_E));
+        TNECS_CHECK(TNECS_WRITE(f, A_hdr, 4));
+        TNECS_CHECK(TNECS_WRITE(f, W->byA.arr[tID].Cs_id, num_Cs));
+        for (size_t C_O = 0; C_O < num_Cs; C_O++) {
+            size_t C_id = W->byA.arr[tID].Cs_id[C_O];
+            unsigned long long off = pos;
+            TNECS_CHECK(TNECS_WRITE(f, &off, 1));
+            pos = tnecs_save_align(pos + A_num_Es * W->Cs.bytesizes[C_id]);
+        }
+    }
+
+    /* 2. Sections, each one block */
+    pos = (size_t)(ftell(f) - base);
+    TNECS_CHECK(tnecs_save_pad(f, &pos));
+    TNECS_CHECK(pos == hdr[7]);
+    TNECS_CHECK(tnecs_save_section(f, &pos, W->Es.id,
+                                   num_Es * sizeof(*W->Es.id)));
+    TNECS_CHECK(tnecs_save_section(f, &pos, W->Es.Os,
+                                   num_Es * sizeof(*W->Es.Os)));
+    TNECS_CHECK(tnecs_save_section(f, &pos, W->Es.As,
+                                   num_Es * sizeof(*W->Es.As)));
+    if (W->Es.gen != NULL)
+        TNECS_CHECK(tnecs_save_section(f, &pos, W->Es.gen,
+                                       num_Es * sizeof(*W->Es.gen)));
+    for (size_t tID = 0; tID < W->byA.num; tID++) {
+        size_t A_num_Es = W->byA.arr[tID].num_Es;
+        TNECS_CHECK(tnecs_save_section(f, &pos, W->byA.arr[tID].Es,
+                                       A_num_Es * sizeof(tnecs_E)));
+        for (size_t C_O = 0; C_O < W->byA.arr[tID].num_Cs; C_O++) {
+            size_t C_id = W->byA.arr[tID].Cs_id[C_O];
+            TNECS_CHECK(tnecs_save_section(f, &pos, W->byA.arr[tID].Cs[C_O].Cs,
+                                           A_num_Es * W->Cs.bytesizes[C_id]));
+        }
+    }
+    return (1);
+}
+
+int tnecs_load_at(FILE *f,     long    base,
+                  unsigned long long off,
+                  void *dst,   size_t  bytes,
+                  size_t *end) {
+    /* Read section at base + off, come back to meta.
+    ** Sections in order: last one read ends snapshot */
+    tnecs_byte *arr = dst;
+    long meta = ftell(f);
+    TNECS_CHECK(meta >= 0);
+    TNECS_CHECK(fseek(f, base + (long)off, SEEK_SET) == 0);
+    TNECS_CHECK(TNECS_READ(f, arr, bytes));
+    TNECS_CHECK(fseek(f, meta, SEEK_SET) == 0);
+    *end = tnecs_save_align(off + bytes);
+    return (1);
+}
+
+int tnecs_load_meta(tnecs_W **W, const unsigned long long *hdr,
+                    const tnecs_Config *config,
+                    const tnecs_Alloc  *alloc) {
+    /* Fresh world, sized for snapshot header */
+    TNECS_CHECK(hdr[0] == TNECS_SAVE_VERSION);
+    TNECS_CHECK(hdr[1] <= TNECS_C_CAP);
+    TNECS_CHECK(hdr[3] < TNECS_E_CAP);
+    TNECS_CHECK(tnecs_genesis_config(W, config, alloc));
+    tnecs_W *world  = *W;
+    world->Cs.num   = hdr[1];
+    world->reuse_Es = hdr[2];
+    world->gen_Es   = hdr[10];
+    TNECS_CHECK(!world->gen_Es || (hdr[11] > 0));
+    world->Es.num       = hdr[3];
+    world->Es.open.num  = hdr[5];
+    TNECS_CHECK(tnecs_reserve_open(world, hdr[5] + 1));
+    return (1);
+}
+
+int tnecs_load_A(tnecs_W *W, size_t tID,
+                 const unsigned long long *A_hdr) {
+    /* Archetypes, registered in same order -> same A_id */
+    TNECS_CHECK(A_hdr[1] < TNECS_C_CAP);
+    if (tID > TNECS_NULL)
+        TNECS_CHECK(_tnecs_register_A(W, A_hdr[1], A_hdr[0]) == tID);
+    TNECS_CHECK(W->byA.arr[tID].num_Cs == A_hdr[1]);
+    W->byA.arr[tID].num_Es = A_hdr[2];
+    return (1);
+}
+
+int tnecs_W_load(tnecs_W **W, FILE *f) {
+    return (tnecs_W_load_config(W, f, NULL, NULL));
+}
+
+int tnecs_W_load_config(tnecs_W **W, FILE *f,
+                        const tnecs_Config *config,
+                        const tnecs_Alloc  *alloc) {
+    char magic[sizeof(TNECS_SAVE_MAGIC)] = {0};
+    size_t magic_len = strlen(TNECS_SAVE_MAGIC);
+    unsigned long long hdr[TNECS_SAVE_HDR];
+    TNECS_CHECK(f != NULL);
+    long   base = ftell(f);
+    size_t end  = 0;
+    TNECS_CHECK(base >= 0);
+    TNECS_CHECK(fread(magic, 1, magic_len, f) == magic_len);
+    TNECS_CHECK(strcmp(magic, TNECS_SAVE_MAGIC) == 0);
+    TNECS_CHECK(TNECS_READ(f, hdr, TNECS_SAVE_HDR));
+    TNECS_CHECK(tnecs_load_meta(W, hdr, config, alloc));
+    tnecs_W *world = *W;
+    TNECS_CHECK(TNECS_READ(f, world->Cs.bytesizes, world->Cs.num));
+    tnecs_E *open = world->Es.open.arr;
+    TNECS_CHECK(TNECS_READ(f, open, world->Es.open.num));
+
+    /* Es table */
+    size_t num_Es = world->Es.num;
+    TNECS_CHECK(tnecs_reserve_E(world, (hdr[4] > num_Es) ? hdr[4] : num_Es));
+    TNECS_CHECK(tnecs_load_at(f, base, hdr[7], world->Es.id,
+                              num_Es * sizeof(*world->Es.id), &end));
+    TNECS_CHECK(tnecs_load_at(f, base, hdr[8], world->Es.Os,
+                              num_Es * sizeof(*world->Es.Os), &end));
+    TNECS_CHECK(tnecs_load_at(f, base, hdr[9], world->Es.As,
+                              num_Es * sizeof(*world->Es.As), &end));
+    if (hdr[11] > 0) {
+        world->Es.gen = tnecs_calloc(world, world->Es.len,
+                                     sizeof(*world->Es.gen));
+        TNECS_CHECK(world->Es.gen);
+        TNECS_CHECK(tnecs_load_at(f, base, hdr[11], world->Es.gen,
+                                  num_Es * sizeof(*world->Es.gen), &end));
+    }
+    TNECS_CHECK(tnecs_open_bits(world));
+
+    /* Archetypes: reserve once, read each section in place */
+    for (size_t tID = 0; tID < hdr[6]; tID++) {
+        unsigned long long A_hdr[4];
+        TNECS_CHECK(TNECS_READ(f, A_hdr, 4));
+        TNECS_CHECK(tnecs_load_A(world, tID, A_hdr));
+        size_t num_Cs = A_hdr[1];
+        num_Es        = A_hdr[2];
+        TNECS_CHECK(TNECS_READ(f, world->byA.arr[tID].Cs_id, num_Cs));
+        TNECS_CHECK(tnecs_reserve_byA(world, tID, num_Es));
+        TNECS_CHECK(tnecs_load_at(f, base, A_hdr[3], world->byA.arr[tID].Es,
+                                  num_Es * sizeof(tnecs_E), &end));
+        for (size_t C_O = 0; C_O < num_Cs; C_O++) {
+            unsigned long long off;
+            TNECS_CHECK(TNECS_READ(f, &off, 1));
+            size_t       C_id   = world->byA.arr[tID].Cs_id[C_O];
+            tnecs_C_arr *C_arr  = &world->byA.arr[tID].Cs[C_O];
+            C_arr->num          = num_Es;
+            TNECS_CHECK(tnecs_load_at(f, base, off, C_arr->Cs,
+                                      num_Es * world->Cs.bytesizes[C_id],
+                                      &end));
+        }
+    }
+    /* Stream left after snapshot, like after save */
+    TNECS_CHECK(fseek(f, base + (long)end, SEEK_SET) == 0);
+    return (1);
+}
+
+#ifdef TNECS_MMAP
+int tnecs_map_read(const tnecs_byte **cur, void *dst, size_t bytes) {
+    /* Meta may be unaligned: copy */
+    if (bytes > 0)
+        memcpy(dst, *cur, bytes);
+    *cur += bytes;
+    return (1);
+}
+
+int tnecs_W_map(tnecs_W **W, const char *path) {
+    return (tnecs_W_map_config(W, path, NULL, NULL));
+}
+
+int tnecs_W_map_config(tnecs_W **W, const char *path,
+                       const tnecs_Config *config,
+                       const tnecs_Alloc  *alloc) {
+    int fd = open(path, O_RDONLY);
+    TNECS_CHECK(fd >= 0);
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        close(fd);
+        return (0);
+    }
+    size_t len = st.st_size;
+    void *base = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    TNECS_CHECK(base != MAP_FAILED);
+
+    /* Meta */
+    const tnecs_byte *map = base;
+    const tnecs_byte *cur = map;
+    size_t magic_len = strlen(TNECS_SAVE_MAGIC);
+    unsigned long long hdr[TNECS_SAVE_HDR];
+    if ((len < magic_len + sizeof(hdr)) ||
+        (memcmp(cur, TNECS_SAVE_MAGIC, magic_len) != 0)) {
+        munmap(base, len);
+        return (0);
+    }
+    cur += magic_len;
+    tnecs_map_read(&cur, hdr, sizeof(hdr));
+    if (!tnecs_load_meta(W, hdr, config, alloc)) {
+        munmap(base, len);
+        return (0);
+    }
+    tnecs_W *world  = *W;
+    world->map.base = base;
+    world->map.len  = len;
+    tnecs_map_read(&cur, world->Cs.bytesizes,
+                   world->Cs.num * sizeof(*world->Cs.bytesizes));
+    tnecs_map_read(&cur, world->Es.open.arr,
+                   world->Es.open.num * sizeof(tnecs_E));
+
+    /* Es table: point into map */
+    size_t num_Es = world->Es.num;
+    TNECS_CHECK(hdr[9] + num_Es * sizeof(*world->Es.As) <= len);
+    TNECS_CHECK((hdr[11] == 0) ||
+                (hdr[11] + num_Es * sizeof(*world->Es.gen) <= len));
+    tnecs_free(world, world->Es.id, world->Es.len * sizeof(tnecs_E));
+    tnecs_free(world, world->Es.Os, world->Es.len * sizeof(size_t));
+    tnecs_free(world, world->Es.As, world->Es.len * sizeof(tnecs_C));
+    TNECS_CHECK(tnecs_grow_Es_aux(world, world->Es.len, num_Es));
+    world->Es.len   = num_Es;
+    TNECS_CHECK(tnecs_open_bits(world));
+    world->Es.id    = (void *)(map + hdr[7]);
+    world->Es.Os    = (void *)(map + hdr[8]);
+    world->Es.As    = (void *)(map + hdr[9]);
+    if (hdr[11] > 0)
+        world->Es.gen   = (void *)(map + hdr[11]);
+
+    /* Archetypes: Es & columns point into map */
+    for (size_t tID = 0; tID < hdr[6]; tID++) {
+        unsigned long long A_hdr[4];
+        tnecs_map_read(&cur, A_hdr, sizeof(A_hdr));
+        TNECS_CHECK(tnecs_load_A(world, tID, A_hdr));
+        size_t num_Cs = A_hdr[1];
+        num_Es        = A_hdr[2];
+        tnecs_map_read(&cur, world->byA.arr[tID].Cs_id,
+                       num_Cs * sizeof(tnecs_C));
+        TNECS_CHECK(A_hdr[3] + num_Es * sizeof(tnecs_E) <= len);
+        if (num_Es > 0) {
+            tnecs_free(world, world->byA.arr[tID].Es,
+                       world->byA.arr[tID].len_Es * sizeof(tnecs_E));
+            world->byA.arr[tID].Es      = (void *)(map + A_hdr[3]);
+            world->byA.arr[tID].len_Es  = num_Es;
+        }
+        for (size_t C_O = 0; C_O < num_Cs; C_O++) {
+            unsigned long long off;
+            tnecs_map_read(&cur, &off, sizeof(off));
+            size_t       C_id   = world->byA.arr[tID].Cs_id[C_O];
+            tnecs_C_arr *C_arr  = &world->byA.arr[tID].Cs[C_O];
+            TNECS_CHECK(off + num_Es * world->Cs.bytesizes[C_id] <= len);
+            C_arr->num          = num_Es;
+            if (num_Es > 0) {
+                tnecs_free(world, C_arr->Cs,
+                           C_arr->len * world->Cs.bytesizes[C_id]);
+                C_arr->Cs   = (void *)(map + off);
+                C_arr->len  = num_Es;
+            }
+        }
+    }
+    world->plan.stale = 1;
+    return (1);
+}
+
+void tnecs_unmap(tnecs_W *W) {
+    /* Forget arrays still in map, then unmap */
+    if (W->map.base == NULL)
+        return;
+    if (tnecs_mapped(W, W->Es.id))
+        W->Es.id = NULL;
+    if (tnecs_mapped(W, W->Es.Os))
+        W->Es.Os = NULL;
+    if (tnecs_mapped(W, W->Es.As))
+        W->Es.As = NULL;
+    if (tnecs_mapped(W, W->Es.gen))
+        W->Es.gen = NULL;
+    for (size_t tID = 0; tID < W->byA.num; tID++) {
+        if (tnecs_mapped(W, W->byA.arr[tID].Es))
+            W->byA.arr[tID].Es = NULL;
+        for (size_t C_O = 0; C_O < W->byA.arr[tID].num_Cs; C_O++) {
+            if (tnecs_mapped(W, W->byA.arr[tID].Cs[C_O].Cs))
+                W->byA.arr[tID].Cs[C_O].Cs = NULL;
+        }
+    }
+    munmap(W->map.base, W->map.len);
+    W->map.base = NULL;
+    W->map.len  = 0;
+}
+#endif /* TNECS_MMAP */
+
+int tnecs_mapped(const tnecs_W *W, const void *ptr) {
+    /* Is ptr inside snapshot map? Never freed. */
+    const tnecs_byte *base = W->map.base;
+    const tnecs_byte *addr = ptr;
+    return ((base != NULL) && (addr >= base) && (addr < base + W->map.len));
+}
+
+/******************* DELTAS *******************/
+int tnecs_read_u(FILE *f, unsigned long long *u) {
+    /* LEB128, see tnecs_write_u */
+    int byte, shift = 0;
+    *u = 0;
+    do {
+        byte = fgetc(f);
+        TNECS_CHECK((byte != EOF) && (shift < 64));
+        *u |= (unsigned long long)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return (1);
+}
+
+int tnecs_delta_row(FILE *f, const tnecs_byte *now,
+                    const tnecs_byte *old, size_t bytesize) {
+    /* XOR with old row, or with zeros if NULL.
+    ** RLE: (num equal bytes, num changed bytes, changed^old)... */
+    size_t i = 0;
+    while (i < bytesize) {
+        size_t same = 0, run = 0;
+        while ((i + same < bytesize) &&
+               (now[i + same] == (old ? old[i + same] : 0)))
+            same++;
+        i += same;
+        while ((i + run < bytesize) &&
+               (now[i + run] != (old ? old[i + run] : 0)))
+            run++;
+        tnecs_write_u(f, same);
+        tnecs_write_u(f, run);
+        for (size_t j = i; j < i + run; j++)
+            TNECS_CHECK(fputc(now[j] ^ (old ? old[j] : 0), f) != EOF);
+        i += run;
+    }
+    return (1);
+}
+
+const tnecs_byte *tnecs_delta_base(const tnecs_W *base, tnecs_E E,
+                                   size_t C_id) {
+    /* Baseline row of E's component, NULL if none */
+    if ((TNECS_E_IDX(base, E) >= base->Es.num) || !TNECS_E_EXISTS(base, E))
+        return (NULL);
+    tnecs_C A = base->Es.As[TNECS_E_IDX(base, E)];
+    if (!TNECS_A_HAS_T(TNECS_C_ID2T(C_id), A))
+        return (NULL);
+    size_t tID = tnecs_A_id(base, A);
+    size_t C_O = tnecs_C_O_byA(base, C_id, A);
+    const tnecs_byte *C = base->byA.arr[tID].Cs[C_O].Cs;
+    return (C + base->Es.Os[TNECS_E_IDX(base, E)] * base->Cs.bytesizes[C_id]);
+}
+
+int tnecs_W_diff(const tnecs_W *base, const tnecs_W *W, FILE *f) {
+    /* Layout: magic, version, Es num, reuse_Es, then ops:
+    **  1. Destroyed, created Es, archetype changes
+    **  2. Changed rows, column by column
+    **  3. Open list */
+    TNECS_CHECK(f != NULL);
+    TNECS_CHECK(base->Cs.num == W->Cs.num);
+    TNECS_CHECK(memcmp(base->Cs.bytesizes, W->Cs.bytesizes,
+                       W->Cs.num * sizeof(*W->Cs.bytesizes)) == 0);
+    size_t magic_len = strlen(TNECS_DELTA_MAGIC);
+    TNECS_CHECK(fwrite(TNECS_DELTA_MAGIC, 1, magic_len, f) == magic_len);
+    tnecs_write_u(f, TNECS_DELTA_VERSION);
+    tnecs_write_u(f, W->Es.num);
+    tnecs_write_u(f, W->reuse_Es);
+
+    /* 1. Es */
+    size_t num = (W->Es.num > base->Es.num) ? W->Es.num : base->Es.num;
+    for (size_t idx = TNECS_NULLSHIFT; idx < num; idx++) {
+        /* Handles: index reused by other E is destroy & create */
+        tnecs_E E_base  = (idx < base->Es.num) ? base->Es.id[idx] : 0;
+        tnecs_E E       = (idx < W->Es.num)    ? W->Es.id[idx]    : 0;
+        if ((E_base != TNECS_NULL) && (E_base != E)) {
+            fputc(TNECS_DELTA_DESTROY, f);
+            tnecs_write_u(f, E_base);
+        }
+        if ((E != TNECS_NULL) && (E_base != E)) {
+            fputc(TNECS_DELTA_CREATE, f);
+            tnecs_write_u(f, E);
+            tnecs_write_u(f, W->Es.As[idx]);
+        } else if ((E != TNECS_NULL) && (base->Es.As[idx] != W->Es.As[idx])) {
+            fputc(TNECS_DELTA_A, f);
+            tnecs_write_u(f, E);
+            tnecs_write_u(f, W->Es.As[idx]);
+        }
+    }
+
+    /* 2. Columns, linearly */
+    for (size_t tID = 1; tID < W->byA.num; tID++) {
+        tnecs_C A       = W->byA.arr[tID].A;
+        size_t num_Es   = W->byA.arr[tID].num_Es;
+        size_t num_Cs   = W->byA.arr[tID].num_Cs;
+        size_t base_tID = tnecs_A_id(base, A);
+
+        /* Same Es, same order: rows match baseline rows */
+        int same_Es = (base_tID > 0) && (base->byA.arr[base_tID].A == A) &&
+                      (base->byA.arr[base_tID].num_Es == num_Es) &&
+                      ((num_Es == 0) ||
+                       (memcmp(base->byA.arr[base_tID].Es, W->byA.arr[tID].Es,
+                               num_Es * sizeof(tnecs_E)) == 0));
+        int same_Cs = same_Es;
+        for (size_t C_O = 0; same_Cs && (C_O < num_Cs); C_O++) {
+            size_t C_id = W->byA.arr[tID].Cs_id[C_O];
+            same_Cs = (num_Es == 0) ||
+                      (memcmp(base->byA.arr[base_tID].Cs[C_O].Cs,
+                              W->byA.arr[tID].Cs[C_O].Cs,
+                              num_Es * W->Cs.bytesizes[C_id]) == 0);
+        }
+        if (same_Cs)
+            continue; /* Skip unchanged archetype */
+
+        for (size_t C_O = 0; C_O < num_Cs; C_O++) {
+            size_t C_id             = W->byA.arr[tID].Cs_id[C_O];
+            size_t bytesize         = W->Cs.bytesizes[C_id];
+            const tnecs_byte *now   = W->byA.arr[tID].Cs[C_O].Cs;
+            const tnecs_byte *old   = NULL;
+            if (same_Es)
+                old = base->byA.arr[base_tID].Cs[C_O].Cs;
+            for (size_t E_O = 0; E_O < num_Es; E_O++) {
+                tnecs_E E = W->byA.arr[tID].Es[E_O];
+                const tnecs_byte *old_row = same_Es ?
+                                            old + E_O * bytesize :
+                                            tnecs_delta_base(base, E, C_id);
+                const tnecs_byte *row = now + E_O * bytesize;
+                if (old_row && (memcmp(row, old_row, bytesize) == 0))
+                    continue;
+                fputc(TNECS_DELTA_C, f);
+                tnecs_write_u(f, E);
+                tnecs_write_u(f, C_id);
+                TNECS_CHECK(tnecs_delta_row(f, row, old_row, bytesize));
+            }
+        }
+    }
+
+    /* 3. Open list */
+    const tnecs_E *open = W->Es.open.arr;
+    fputc(TNECS_DELTA_OPEN, f);
+    tnecs_write_u(f, W->Es.open.num);
+    for (size_t i = 0; i < W->Es.open.num; i++)
+        tnecs_write_u(f, open[i]);
+    TNECS_CHECK(fputc(TNECS_DELTA_END, f) != EOF);
+    return (1);
+}
+
+int tnecs_E_claim(tnecs_W *W, tnecs_E E) {
+    /* Create specific entity handle, in null archetype */
+    size_t idx = TNECS_E_IDX(W, E);
+    TNECS_CHECK((idx > TNECS_NULL) && (idx < TNECS_E_CAP));
+    if (W->locked && ((idx >= W->Es.len) || !tnecs_room(W, TNECS_NULL)))
+        return (tnecs_reject(W));
+    while (idx >= W->Es.len)
+        TNECS_CHECK(tnecs_grow_E(W));
+    TNECS_CHECK((W->Es.id[idx] == TNECS_NULL) || (idx >= W->Es.num));
+    if (idx >= W->Es.num)
+        W->Es.num = idx + 1;
+    W->Es.id[idx] = E;
+    if (W->Es.gen != NULL)
+        W->Es.gen[idx] = TNECS_E_GEN(E);
+    TNECS_CHECK(tnecs_EsbyA_add(W, E, TNECS_NULL));
+    return (1);
+}
+
+int tnecs_C_zero(tnecs_W *W, tnecs_E E, tnecs_C A) {
+    /* Added Cs: baseline is zeros. Added without finit:
+    ** nothing to free before overwriting */
+    for (size_t C_id = 1; C_id < W->Cs.num; C_id++) {
+        if (!TNECS_A_HAS_T(TNECS_C_ID2T(C_id), A))
+            continue;
+        void *C = tnecs_get_C(W, E, C_id);
+        TNECS_CHECK(C != NULL);
+        memset(C, 0, W->Cs.bytesizes[C_id]);
+    }
+    return (1);
+}
+
+int tnecs_W_apply(tnecs_W *W, FILE *f) {
+    /* W must be in the delta's baseline state */
+    char magic[sizeof(TNECS_DELTA_MAGIC)] = {0};
+    size_t magic_len = strlen(TNECS_DELTA_MAGIC);
+    unsigned long long version, num_Es, reuse_Es, E, A, C_id, num;
+    TNECS_CHECK(f != NULL);
+    /* Locked: rejected whole, not half applied */
+    if (W->locked)
+        return (tnecs_reject(W));
+    TNECS_CHECK(fread(magic, 1, magic_len, f) == magic_len);
+    TNECS_CHECK(strcmp(magic, TNECS_DELTA_MAGIC) == 0);
+    TNECS_CHECK(tnecs_read_u(f, &version));
+    TNECS_CHECK(version == TNECS_DELTA_VERSION);
+    TNECS_CHECK(tnecs_read_u(f, &num_Es));
+    TNECS_CHECK(tnecs_read_u(f, &reuse_Es));
+    TNECS_CHECK(num_Es < TNECS_E_CAP);
+
+    int op;
+    while ((op = fgetc(f)) != TNECS_DELTA_END) {
+        switch (op) {
+            case TNECS_DELTA_DESTROY:
+                TNECS_CHECK(tnecs_read_u(f, &E));
+                TNECS_CHECK(TNECS_E_EXISTS(W, E));
+                TNECS_CHECK(tnecs_E_destroy(W, E));
+                break;
+            case TNECS_DELTA_CREATE:
+                TNECS_CHECK(tnecs_read_u(f, &E));
+                TNECS_CHECK(tnecs_read_u(f, &A));
+                TNECS_CHECK(tnecs_E_claim(W, E));
+                if (A != TNECS_NULL) {
+                    TNECS_CHECK(_tnecs_E_add_C(W, E, A, 1, 0));
+                    TNECS_CHECK(tnecs_C_zero(W, E, A));
+                }
+                break;
+            case TNECS_DELTA_A: {
+                TNECS_CHECK(tnecs_read_u(f, &E));
+                TNECS_CHECK(tnecs_read_u(f, &A));
+                TNECS_CHECK(TNECS_E_EXISTS(W, E));
+                tnecs_C A_old = W->Es.As[TNECS_E_IDX(W, E)];
+                tnecs_C A_add = A & ~A_old;
+                tnecs_C A_rm  = A_old & ~A;
+                if (A_add != TNECS_NULL) {
+                    TNECS_CHECK(_tnecs_E_add_C(W, E, A_add, 1, 0));
+                    TNECS_CHECK(tnecs_C_zero(W, E, A_add));
+                }
+                if (A_rm != TNECS_NULL)
+                    TNECS_CHECK(tnecs_E_rm_C(W, E, A_rm));
+                break;
+            }
+            case TNECS_DELTA_C: {
+                TNECS_CHECK(tnecs_read_u(f, &E));
+                TNECS_CHECK(tnecs_read_u(f, &C_id));
+                TNECS_CHECK(C_id < W->Cs.num);
+                tnecs_byte *row = tnecs_get_C(W, E, C_id);
+                TNECS_CHECK(row != NULL);
+                size_t bytesize = W->Cs.bytesizes[C_id];
+                unsigned long long same, run;
+                for (size_t i = 0; i < bytesize; i += run) {
+                    TNECS_CHECK(tnecs_read_u(f, &same));
+                    TNECS_CHECK(tnecs_read_u(f, &run));
+                    i += same;
+                    TNECS_CHECK(i + run <= bytesize);
+                    for (size_t j = i; j < i + run; j++) {
+                        int byte = fgetc(f);
+                        TNECS_CHECK(byte != EOF);
+                        row[j] ^= (tnecs_byte)byte;
+                    }
+                }
+                break;
+            }
+            case TNECS_DELTA_OPEN: {
+                TNECS_CHECK(tnecs_read_u(f, &num));
+                TNECS_CHECK(num < TNECS_E_CAP);
+                TNECS_CHECK(tnecs_reserve_open(W, num + 1));
+                tnecs_E *open = W->Es.open.arr;
+                for (size_t i = 0; i < num; i++)
+                    TNECS_CHECK(tnecs_read_u(f, &open[i]));
+                W->Es.open.num = num;
+                TNECS_CHECK(tnecs_open_bits(W));
+                break;
+            }
+            default:
+                printf("tnecs: invalid delta op %d\n", op);
+                return (0);
+        }
+    }
+
+    /* Next created Es match delta's world */
+    TNECS_CHECK(tnecs_reserve_E(W, num_Es));
+    if (num_Es > W->Es.num)
+        W->Es.num = num_Es;
+    W->reuse_Es = reuse_Es;
+    return (1);
+}
+
+/******************* COMMANDS *******************/
+int tnecs_cmd_create(tnecs_W *W, tnecs_C A, const void *Cs) {
+    return (tnecs_cmd_push(W, TNECS_CMD_CREATE, TNECS_NULL, A, Cs));
+}
+
+int tnecs_cmd_destroy(tnecs_W *W, tnecs_E E) {
+    return (tnecs_cmd_push(W, TNECS_CMD_DESTROY, E, TNECS_NULL, NULL));
+}
+
+int tnecs_cmd_add_C(tnecs_W *W, tnecs_E E, tnecs_C A, const void *Cs) {
+    TNECS_CHECK(A != TNECS_NULL);
+    return (tnecs_cmd_push(W, TNECS_CMD_ADD_C, E, A, Cs));
+}
+
+int tnecs_cmd_rm_C(tnecs_W *W, tnecs_E E, tnecs_C A) {
+    TNECS_CHECK(A != TNECS_NULL);
+    return (tnecs_cmd_push(W, TNECS_CMD_RM_C, E, A, NULL));
+}
+
+int tnecs_cmd_push(tnecs_W *W,  int         op,
+                   tnecs_E  E,  tnecs_C     A,
+                   const void  *Cs) {
+    /* W's buffer, stamped with running system */
+    tnecs_Cmds *cmds = &W->cmds;
+    size_t bytes = tnecs_cmd_bytes(W, A, Cs);
+    if (W->locked && ((cmds->num >= cmds->len) ||
+                      ((cmds->num_bytes + bytes) > cmds->len_bytes)))
+        return (tnecs_reject(W));
+    return (tnecs_cmds_rec(cmds, W, cmds->S_id, op, E, A, Cs));
+}
+
+size_t tnecs_cmd_bytes(const tnecs_W *W, tnecs_C A, const void *Cs) {
+    size_t bytes = 0;
+    for (size_t C_id = 1; (Cs != NULL) && (C_id < W->Cs.num); C_id++) {
+        if (TNECS_A_HAS_T(TNECS_C_ID2T(C_id), A))
+            bytes += W->Cs.bytesizes[C_id];
+    }
+    return (bytes);
+}
+
+int tnecs_cmds_push(tnecs_Cmds      *cmds,  const tnecs_In *input,
+                    int              op,    tnecs_E         E,
+                    tnecs_C          A,     const void     *Cs) {
+    return (tnecs_cmds_rec(cmds, input->world, input->S_id, op, E, A, Cs));
+}
+
+int tnecs_cmds_rec(tnecs_Cmds      *cmds,  const tnecs_W  *W,
+                   size_t           S_id,  int             op,
+                   tnecs_E          E,     tnecs_C         A,
+                   const void      *Cs) {
+    /* W only read: any thread, own buffer */
+    TNECS_CHECK((op >= TNECS_CMD_CREATE) && (op <= TNECS_CMD_RM_C));
+    TNECS_CHECK((A >> (W->Cs.num - 1)) == 0); /* Registered Cs */
+    size_t bytes = tnecs_cmd_bytes(W, A, Cs);
+    if (cmds->num >= cmds->len) {
+        size_t olen = cmds->len;
+        size_t nlen = (olen > 0) ? tnecs_grow_len(W, olen, olen + 1) :
+                                   TNECS_CMD_0LEN;
+        void *arr   = cmds->arr;
+        TNECS_CHECK(tnecs_cmds_grow(cmds, &arr, olen, nlen,
+                                    sizeof(*cmds->arr)));
+        cmds->arr   = arr;
+        cmds->len   = nlen;
+    }
+    if ((cmds->num_bytes + bytes) > cmds->len_bytes) {
+        size_t olen = cmds->len_bytes;
+        size_t nlen = tnecs_grow_len(W, (olen > 0) ? olen : TNECS_CMD_0BYTES,
+                                     cmds->num_bytes + bytes);
+        void *arr   = cmds->bytes;
+        TNECS_CHECK(tnecs_cmds_grow(cmds, &arr, olen, nlen, 1));
+        cmds->bytes     = arr;
+        cmds->len_bytes = nlen;
+    }
+
+    tnecs_Cmd *cmd  = &cmds->arr[cmds->num];
+    cmd->op         = op;
+    cmd->E          = E;
+    cmd->A          = A;
+    cmd->S_id       = S_id;
+    cmd->seq        = cmds->num++;
+    cmd->off        = cmds->num_bytes;
+    cmd->bytes      = bytes;
+    if (bytes > 0)
+        memcpy(cmds->bytes + cmd->off, Cs, bytes);
+    cmds->num_bytes += bytes;
+    return (1);
+}
+
+int tnecs_cmds_grow(tnecs_Cmds *cmds,  void  **ptr,
+                    size_t      olen,  size_t  nlen,
+                    size_t      bytesize) {
+    /* Buffer's allocator, not W's: other threads */
+    const tnecs_Alloc *alloc = &cmds->alloc;
+    void *out;
+    if ((*ptr != NULL) && (alloc->realloc != NULL)) {
+        out = alloc->realloc(alloc->ctx, *ptr, olen * bytesize,
+                             nlen * bytesize);
+        TNECS_CHECK(out);
+    } else {
+        out = alloc->alloc(alloc->ctx, nlen * bytesize);
+        TNECS_CHECK(out);
+        if (*ptr != NULL) {
+            memcpy(out, *ptr, olen * bytesize);
+            alloc->free(alloc->ctx, *ptr, olen * bytesize);
+        }
+    }
+    *ptr = out;
+    return (1);
+}
+
+int tnecs_cmds_genesis(tnecs_Cmds *cmds, const tnecs_Alloc *alloc) {
+    tnecs_Alloc std = {tnecs_std_alloc, NULL, tnecs_std_free, NULL};
+    if (alloc == NULL)
+        alloc = &std;
+    TNECS_CHECK((alloc->alloc != NULL) && (alloc->free != NULL));
+    memset(cmds, 0, sizeof(*cmds));
+    cmds->alloc = *alloc;
+    return (1);
+}
+
+int tnecs_cmds_finale(tnecs_Cmds *cmds) {
+    const tnecs_Alloc *alloc = &cmds->alloc;
+    if (cmds->arr != NULL)
+        alloc->free(alloc->ctx, cmds->arr, cmds->len * sizeof(tnecs_Cmd));
+    if (cmds->bytes != NULL)
+        alloc->free(alloc->ctx, cmds->bytes, cmds->len_bytes);
+    memset(cmds, 0, sizeof(*cmds));
+    return (1);
+}
+
+int tnecs_cmds_merge(tnecs_W *W, tnecs_Cmds *bufs, size_t num) {
+    /* Appended in bufs order, applied by S_id then order:
+    **  same as serial if a system's tables fill bufs in order */
+    tnecs_Cmds *cmds = &W->cmds;
+    for (size_t b = 0; b < num; b++) {
+        for (size_t i = 0; i < bufs[b].num; i++) {
+            const tnecs_Cmd *cmd = &bufs[b].arr[i];
+            size_t bytes = cmd->bytes;
+            if (W->locked && ((cmds->num >= cmds->len) ||
+                              ((cmds->num_bytes + bytes) > cmds->len_bytes)))
+                return (tnecs_reject(W));
+            const void *Cs = (bytes > 0) ? bufs[b].bytes + cmd->off : NULL;
+            TNECS_CHECK(tnecs_cmds_rec(cmds, W, cmd->S_id, cmd->op,
+                                       cmd->E, cmd->A, Cs));
+        }
+        /* Arena reset: memory kept for next step */
+        bufs[b].num         = 0;
+        bufs[b].num_bytes   = 0;
+    }
+    return (1);
+}
+
+int tnecs_cmd_cmp(const void *a, const void *b) {
+    /* Non-creates first, creates by A. Then by S, in order */
+    const tnecs_Cmd *cmd_a = a, *cmd_b = b;
+    int create_a = (cmd_a->op == TNECS_CMD_CREATE);
+    int create_b = (cmd_b->op == TNECS_CMD_CREATE);
+    if (create_a != create_b)
+        return (create_a - create_b);
+    if (create_a && (cmd_a->A != cmd_b->A))
+        return ((cmd_a->A < cmd_b->A) ? -1 : 1);
+    if (cmd_a->S_id != cmd_b->S_id)
+        return ((cmd_a->S_id < cmd_b->S_id) ? -1 : 1);
+    return ((cmd_a->seq < cmd_b->seq) ? -1 : (cmd_a->seq > cmd_b->seq));
+}
+
+int tnecs_C_set(tnecs_W *W, tnecs_E E, tnecs_C A, const tnecs_byte *Cs) {
+    /* Cs of A by increasing C_id replace initialized Cs */
+    for (size_t C_id = 1; C_id < W->Cs.num; C_id++) {
+        if (!TNECS_A_HAS_T(TNECS_C_ID2T(C_id), A))
+            continue;
+        void *C = tnecs_get_C(W, E, C_id);
+        TNECS_CHECK(C != NULL);
+        if (W->Cs.ffree[C_id] != NULL)
+            W->Cs.ffree[C_id](C);
+        memcpy(C, Cs, W->Cs.bytesizes[C_id]);
+        Cs += W->Cs.bytesizes[C_id];
+    }
+    return (1);
+}
+
+int tnecs_cmds_create(tnecs_W *W, const tnecs_Cmd *cmds,
+                      size_t   num, size_t *done) {
+    /* num creates of same A: reserve once, then create.
+    ** done: creates applied, failed one rolled back */
+    tnecs_C A       = cmds[0].A;
+    size_t  open    = W->reuse_Es ? W->Es.open.num : 0;
+    size_t  bumped  = (num > open) ? (num - open) : 0;
+    size_t  tID     = TNECS_NULL;
+    if (!W->locked) {
+        TNECS_CHECK(tnecs_reserve_E(W, W->Es.num + bumped + 1));
+        if (A != TNECS_NULL)
+            tID = _tnecs_register_A(W, setBits_KnR(A), A);
+        TNECS_CHECK((tID != TNECS_NULL) || (A == TNECS_NULL));
+        size_t num_Es = W->byA.arr[tID].num_Es;
+        TNECS_CHECK(tnecs_reserve_byA(W, tID, num_Es + num + 1));
+    }
+
+    for (size_t i = 0; i < num; i++) {
+        if (W->locked && !tnecs_room(W, A))
+            return (tnecs_reject(W));
+        tnecs_E E = tnecs_E_create(W);
+        TNECS_CHECK(E);
+        /* isNew: recorded calls register A on replay */
+        int ok = (A == TNECS_NULL) || (tnecs_E_add_C(W, E, A, 1) &&
+                 ((cmds[i].bytes == 0) ||
+                  tnecs_C_set(W, E, A, W->cmds.bytes + cmds[i].off)));
+        if (!ok) {
+            /* Rollback never grows, never rejected */
+            TNECS_REC(W, TNECS_REC_DESTROY, E);
+            tnecs_E_del(W, E);
+        }
+        TNECS_CHECK(ok);
+        (*done)++;
+    }
+    return (1);
+}
+
+int tnecs_cmd_apply(tnecs_W *W, const tnecs_Cmd *cmd) {
+    /* Non-create command. Skipped if E was destroyed */
+    if ((TNECS_E_IDX(W, cmd->E) >= W->Es.num) || !TNECS_E_EXISTS(W, cmd->E))
+        return (1);
+    switch (cmd->op) {
+        case TNECS_CMD_DESTROY:
+            TNECS_CHECK(tnecs_E_destroy(W, cmd->E));
+            break;
+        case TNECS_CMD_ADD_C: {
+            /* Cs E already has: set only */
+            tnecs_C A_add = cmd->A & ~W->Es.As[TNECS_E_IDX(W, cmd->E)];
+            if (A_add != TNECS_NULL)
+                TNECS_CHECK(tnecs_E_add_C(W, cmd->E, A_add, 1));
+            if (cmd->bytes > 0)
+                TNECS_CHECK(tnecs_C_set(W, cmd->E, cmd->A,
+                                        W->cmds.bytes + cmd->off));
+            break;
+        }
+        case TNECS_CMD_RM_C: {
+            tnecs_C A_rm = cmd->A & W->Es.As[TNECS_E_IDX(W, cmd->E)];
+            if (A_rm != TNECS_NULL)
+                TNECS_CHECK(tnecs_E_rm_C(W, cmd->E, A_rm));
+            break;
+        }
+    }
+    return (1);
+}
+
+int tnecs_cmds_drop(tnecs_Cmds *cmds, size_t done) {
+    /* Failed apply: forget applied commands, keep the rest */
+    memmove(cmds->arr, cmds->arr + done,
+            (cmds->num - done) * sizeof(*cmds->arr));
+    cmds->num -= done;
+    return (0);
+}
+
+int tnecs_cmds_apply(tnecs_W *W) {
+    tnecs_Cmds *cmds = &W->cmds;
+    if (cmds->num == 0)
+        return (1);
+    qsort(cmds->arr, cmds->num, sizeof(*cmds->arr), tnecs_cmd_cmp);
+
+    size_t done = 0;
+    while ((done < cmds->num) && (cmds->arr[done].op != TNECS_CMD_CREATE)) {
+        if (!tnecs_cmd_apply(W, &cmds->arr[done]))
+            return (tnecs_cmds_drop(cmds, done));
+        done++;
+    }
+
+    /* Creates, one group per archetype */
+    while (done < cmds->num) {
+        size_t j = done + 1;
+        while ((j < cmds->num) && (cmds->arr[j].A == cmds->arr[done].A))
+            j++;
+        size_t created = 0;
+        if (!tnecs_cmds_create(W, &cmds->arr[done], j - done, &created))
+            return (tnecs_cmds_drop(cmds, done + created));
+        done = j;
+    }
+    cmds->num       = 0;
+    cmds->num_bytes = 0;
+    return (1);
+}
+
+/******************** CLONES ********************/
+void *tnecs_dup(tnecs_W *W,         const void *src,
+                size_t num, size_t len, size_t bytesize) {
+    /* Bulk copy of num elements, slack is zeros */
+    if (src == NULL)
+        return (NULL);
+    void *out = tnecs_calloc(W, len, bytesize);
+    if (out != NULL)
+        memcpy(out, src, num * bytesize);
+    return (out);
+}
+
+int tnecs_C_own(tnecs_W *W, tnecs_C_arr *C_arr, size_t bytesize) {
+    /* Copy-on-write: copy column shared with clones before writing */
+    if (C_arr->refs == NULL)
+        return (1);
+    if (*C_arr->refs > 1) {
+        void *Cs = tnecs_dup(W, C_arr->Cs, C_arr->num,
+                             C_arr->len, bytesize);
+        TNECS_CHECK(Cs);
+        --*C_arr->refs;
+        C_arr->Cs = Cs;
+        W->counts.bytes_copied += C_arr->num * bytesize;
+    } else {
+        tnecs_free(W, C_arr->refs, sizeof(*C_arr->refs));
+    }
+    C_arr->refs = NULL;
+    return (1);
+}
+
+int tnecs_clone_Ss(tnecs_W *W, tnecs_Ss *Ss) {
+    size_t len = Ss->len;
+    TNECS_CHECK(TNECS_DUP(W, Ss->Phs,      len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->Os,       len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->Ex,       len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->As,       len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->Pi,       len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->batch,    len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->plan_O,   len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->plan_num, len));
+    TNECS_CHECK(TNECS_DUP(W, Ss->prof,     len));
+    TNECS_CHECK(TNECS_DUP_N(W, Ss->to_run.arr, Ss->to_run.len,
+                            Ss->to_run.len, sizeof(tnecs_S_f)));
+    TNECS_CHECK(TNECS_DUP_N(W, Ss->ran.arr,    Ss->ran.len,
+                            Ss->ran.len,    sizeof(tnecs_S_f)));
+    return (1);
+}
+
+int tnecs_clone_Pis(tnecs_W *W, tnecs_Pis *Pis) {
+    TNECS_CHECK(TNECS_DUP(W, Pis->byPh, Pis->len));
+    for (size_t Pi = 0; Pi < Pis->len; Pi++) {
+        tnecs_Phs *byPh = &Pis->byPh[Pi];
+        TNECS_CHECK(TNECS_DUP(W, byPh->len_Ss, byPh->len));
+        TNECS_CHECK(TNECS_DUP(W, byPh->num_Ss, byPh->len));
+        TNECS_CHECK(TNECS_DUP(W, byPh->Ss,     byPh->len));
+        TNECS_CHECK(TNECS_DUP(W, byPh->Ss_id,  byPh->len));
+        for (size_t Ph = 0; Ph < byPh->len; Ph++) {
+            TNECS_CHECK(TNECS_DUP(W, byPh->Ss[Ph],    byPh->len_Ss[Ph]));
+            TNECS_CHECK(TNECS_DUP(W, byPh->Ss_id[Ph], byPh->len_Ss[Ph]));
+        }
+    }
+    return (1);
+}
+
+int tnecs_clone_As(tnecs_W *W, tnecs_W *clone, int cow) {
+    tnecs_As *byA   = &clone->byA;
+    size_t    len   = byA->len;
+    TNECS_CHECK(TNECS_DUP(W, byA->arr, len));
+
+    for (size_t tID = 0; tID < len; tID++) {
+        tnecs_Arch *arch = &byA->arr[tID];
+        size_t num_Cs = arch->num_Cs;
+        TNECS_CHECK(TNECS_DUP(W, arch->subA, arch->len_A_ids));
+        TNECS_CHECK(TNECS_DUP_N(W, arch->Es, arch->num_Es, arch->len_Es,
+                                sizeof(tnecs_E)));
+        TNECS_CHECK(TNECS_DUP_N(W, arch->Cs, num_Cs, num_Cs,
+                                TNECS_ARCH_C_BYTES));
+        if (arch->Cs != NULL)
+            arch->Cs_id = (tnecs_C *)(arch->Cs + num_Cs);
+
+        /* Columns: copied, or shared until written */
+        for (size_t C_O = 0; C_O < num_Cs; C_O++) {
+            tnecs_C_arr *src    = &W->byA.arr[tID].Cs[C_O];
+            tnecs_C_arr *C_arr  = &byA->arr[tID].Cs[C_O];
+            size_t C_id         = byA->arr[tID].Cs_id[C_O];
+            if (cow && !tnecs_mapped(W, src->Cs)) {
+                if (src->refs == NULL) {
+                    src->refs = tnecs_calloc(W, 1, sizeof(*src->refs));
+                    TNECS_CHECK(src->refs);
+                    *src->refs = 1;
+                }
+                ++*src->refs;
+                C_arr->refs = src->refs;
+                continue;
+            }
+            C_arr->refs = NULL;
+            TNECS_CHECK(TNECS_DUP_N(W, C_arr->Cs, C_arr->num, C_arr->len,
+                                    W->Cs.bytesizes[C_id]));
+        }
+    }
+    return (1);
+}
+
+int _tnecs_W_clone(tnecs_W *W, tnecs_W **out, int cow) {
+    if (*out != NULL)
+        TNECS_CHECK(tnecs_finale(out));
+    tnecs_W *clone = tnecs_calloc(W, 1, sizeof(*clone));
+    TNECS_CHECK(clone);
+
+    /* Sizes, Cs, flags in bulk, then arrays */
+    *clone          = *W;
+    *out            = clone;
+    clone->record   = NULL;
+    clone->map.base = NULL;
+    clone->map.len  = 0;
+    TNECS_CHECK(tnecs_clone_Ss( clone, &clone->Ss));
+    TNECS_CHECK(tnecs_clone_Pis(clone, &clone->Pis));
+    TNECS_CHECK(tnecs_clone_As(W, clone, cow));
+    size_t num = clone->Es.num, len = clone->Es.len;
+    TNECS_CHECK(TNECS_DUP_N(W, clone->Es.id, num, len, sizeof(tnecs_E)));
+    TNECS_CHECK(TNECS_DUP_N(W, clone->Es.Os, num, len, sizeof(size_t)));
+    TNECS_CHECK(TNECS_DUP_N(W, clone->Es.As, num, len, sizeof(tnecs_C)));
+    TNECS_CHECK(TNECS_DUP_N(W, clone->Es.open.arr, clone->Es.open.num,
+                            clone->Es.open.len, sizeof(tnecs_E)));
+    TNECS_CHECK(TNECS_DUP_N(W, clone->Es.gen, num, len, sizeof(size_t)));
+    TNECS_CHECK(TNECS_DUP(W, clone->Es.isOpen, TNECS_BITS_LEN(len)));
+    TNECS_CHECK(TNECS_DUP(W, clone->trace.evs, clone->trace.len));
+    TNECS_CHECK(TNECS_DUP(W, clone->cmds.arr, clone->cmds.len));
+    TNECS_CHECK(TNECS_DUP(W, clone->cmds.bytes, clone->cmds.len_bytes));
+
+    /* Plan is rebuilt on first step */
+    TNECS_CHECK(_tnecs_breath_Plan(clone, &clone->plan));
+    if (cow) /* W's plan points to shared columns */
+        W->plan.stale = 1;
+    return (1);
+}
+
+int tnecs_W_clone(tnecs_W *W, tnecs_W **out) {
+    return (_tnecs_W_clone(W, out, 0));
+}
+
+int tnecs_W_clone_cow(tnecs_W *W, tnecs_W **out) {
+    return (_tnecs_W_clone(W, out, 1));
+}
+
+/* -- Snapshot ring -- */
+int tnecs_ring_genesis(tnecs_Ring *ring, size_t len) {
+    TNECS_CHECK(len > 0);
+    ring->num   = 0;
+    ring->len   = len;
+    ring->Ws    = calloc(len, sizeof(*ring->Ws));
+    TNECS_CHECK(ring->Ws);
+    return (1);
+}
+
+int tnecs_ring_finale(tnecs_Ring *ring) {
+    for (size_t i = 0; i < ring->len; i++) {
+        if (ring->Ws[i] != NULL)
+            TNECS_CHECK(tnecs_finale(&ring->Ws[i]));
+    }
+    free(ring->Ws);
+    ring->Ws    = NULL;
+    ring->num   = 0;
+    ring->len   = 0;
+    return (1);
+}
+
+int tnecs_ring_push(tnecs_Ring *ring, tnecs_W *W) {
+    /* Overwrites oldest snapshot */
+    TNECS_CHECK(tnecs_W_clone_cow(W, &ring->Ws[ring->num % ring->len]));
+    ring->num++;
+    return (1);
+}
+
+tnecs_W *tnecs_ring_get(const tnecs_Ring *ring, size_t back) {
+    size_t kept = (ring->num < ring->len) ? ring->num : ring->len;
+    if (back >= kept)
+        return (NULL);
+    return (ring->Ws[(ring->num - 1 - back) % ring->len]);
+}
+
+int tnecs_ring_rewind(tnecs_Ring *ring, size_t back, tnecs_W **W) {
+    /* W: clone of snapshot. Newer snapshots dropped. */
+    tnecs_W *snap = tnecs_ring_get(ring, back);
+    TNECS_CHECK(snap != NULL);
+    TNECS_CHECK(tnecs_W_clone_cow(snap, W));
+    ring->num -= back;
+    return (1);
+}
+
+/*****************************************************/
+/***************** TNECS INTERNALS *******************/
+/*****************************************************/
+tnecs_E tnecs_E_add_C(  tnecs_W *W,         tnecs_E  E,
+                        tnecs_C  A_toadd,   int      isNew) {
+    return (_tnecs_E_add_C(W, E, A_toadd, isNew, 1));
+}
+
+tnecs_E _tnecs_E_add_C( tnecs_W *W,         tnecs_E  E,
+                        tnecs_C  A_toadd,   int      isNew,
+                        int      init) {
+    /* init: run finit of added Cs */
+    TNECS_REC(W, TNECS_REC_ADD_C, E, A_toadd, isNew);
+    if (A_toadd <= 0) {
+        return (TNECS_NULL);
+    }
+
+    if (!TNECS_E_EXISTS(W, E)) {
+        return (TNECS_NULL);
+    }
+
+    tnecs_C A_old = W->Es.As[TNECS_E_IDX(W, E)];
+
+    if (TNECS_A_HAS_T(A_toadd, A_old)) {
+        return (E);
+    }
+
+    tnecs_C A_new = A_toadd + A_old;
+    assert(A_new != A_old);
+    if (W->locked && !tnecs_room(W, A_new))
+        return (tnecs_reject(W));
+    if (isNew)
+        TNECS_CHECK(_tnecs_register_A(  W, setBits_KnR(A_new), 
+                                        A_new));
+
+    TNECS_CHECK(tnecs_C_migrate(    W, E, A_old, A_new));
+    TNECS_CHECK(tnecs_EsbyA_migrate(W, E, A_old, A_new));
+    if (init)
+        TNECS_CHECK(tnecs_C_init(   W, E, A_toadd));
+
+#ifndef NDEBUG
+    size_t tID_new = tnecs_A_id(W, A_new);
+    size_t new_O = W->byA.arr[tID_new].num_Es - 1;
+    assert(W->Es.As[TNECS_E_IDX(W, E)]                  == A_new);
+    assert(W->byA.arr[tID_new].Es[new_O]    == E);
+    assert(W->Es.Os[TNECS_E_IDX(W, E)]                  == new_O);
+#endif /* NDEBUG */
+    return (W->Es.id[TNECS_E_IDX(W, E)]);
+}
+
+tnecs_E tnecs_E_rm_C(   tnecs_W *W, tnecs_E  E,
+                        tnecs_C  A) {
+    TNECS_REC(W, TNECS_REC_RM_C, E, A);
+    if (!TNECS_E_EXISTS(W, E)) {
+        return (TNECS_NULL);
+    }
+
+    /* Get new archetype. 
+    ** Since it is a archetype, just need to substract. */
+    tnecs_C A_old = W->Es.As[TNECS_E_IDX(W, E)];
+    tnecs_C A_new = A_old - A;
+    if (W->locked && !tnecs_room(W, A_new))
+        return (tnecs_reject(W));
+
+    /* Free removed Cs. */
+    TNECS_CHECK(tnecs_C_free(W, E, A));
+    if (A_new != TNECS_NULL) {
+        /* Migrate remaining Cs to new A array. */
+        TNECS_CHECK(_tnecs_register_A(  W, setBits_KnR(A_new),
+                                        A_new));
+        TNECS_CHECK(tnecs_C_migrate(W, E, A_old, A_new));
+    } else {
+        /* No remaining component, delete everything. */
+        TNECS_CHECK(tnecs_C_del(W, E, A_old));
+    }
+    /* Migrate E to new byA array. */
+    TNECS_CHECK(tnecs_EsbyA_migrate(W, E, A_old, A_new));
+    assert(A_new == W->Es.As[TNECS_E_IDX(W, E)]);
+    return (1);
+}
+
+void *tnecs_get_C(  tnecs_W *W, tnecs_E  E,
+                    tnecs_C  C_id) {
+    if (!TNECS_E_EXISTS(W, E))
+        return (NULL);
+
+    tnecs_C C_flag  = TNECS_C_ID2T(C_id);
+    tnecs_C E_A     = TNECS_E_A(W, E);
+    /* If entity has component, get output it.  */
+    /* If not output NULL. */
+    if (!TNECS_A_HAS_T(C_flag, E_A))
+        return (NULL);
+
+    size_t tID = tnecs_A_id(W, E_A);
+    assert(tID > 0);
+    size_t C_O = tnecs_C_O_byA(W, C_id, E_A);
+    assert(C_O <= W->byA.arr[tID].num_Cs);
+    size_t E_O = W->Es.Os[TNECS_E_IDX(W, E)];
+    size_t bytesize = W->Cs.bytesizes[C_id];
+
+    tnecs_C_arr *C_array = &W->byA.arr[tID].Cs[C_O];
+    assert(C_array != NULL);
+    if (!tnecs_C_own(W, C_array, bytesize))
+        return (NULL);
+    tnecs_byte *temp_C_bytesptr = (tnecs_byte *)(C_array->Cs);
+    void *out = temp_C_bytesptr + (bytesize * E_O);
 
     return (out);
 }
 
 int tnecs_EsbyA_add(tnecs_W *W, tnecs_E E, tnecs_C A_new) {
     size_t tID_new = tnecs_A_id(W, A_new);
-    if ((W->byA.num_Es[tID_new] + 1) >= W->byA.len_Es[tID_new]) {
+    if ((W->byA.arr[tID_new].num_Es + 1) >= W->byA.arr[tID_new].len_Es) {
         TNECS_CHECK(tnecs_grow_byA(W, tID_new));
     }
-    size_t new_O = W->byA.num_Es[tID_new]++;
-    W->Es.Os[E] = new_O;
-    W->Es.As[E] = A_new;
-    W->byA.Es[tID_new][new_O]  = E;
+    size_t new_O = W->byA.arr[tID_new].num_Es++;
+    W->Es.Os[TNECS_E_IDX(W, E)] = new_O;
+    W->Es.As[TNECS_E_IDX(W, E)] = A_new;
+    W->byA.arr[tID_new].Es[new_O]  = E;
     return (1);
 }
 
@@ -1018,52 +2922,55 @@ int tnecs_EsbyA_del(tnecs_W *W, tnecs_E E, tnecs_C A_old) {
     if (!TNECS_E_EXISTS(W, E))
         return (1);
 
-    if (E >= W->Es.len)
+    if (TNECS_E_IDX(W, E) >= W->Es.len)
         return (1);
 
     size_t A_old_id = tnecs_A_id(W, A_old);
-    size_t old_num  = W->byA.num_Es[A_old_id];
+    size_t old_num  = W->byA.arr[A_old_id].num_Es;
     if (old_num <= 0)
         return (1);
 
-    size_t E_O_old = W->Es.Os[E];
-    assert(A_old == W->Es.As[E]);
+    size_t E_O_old = W->Es.Os[TNECS_E_IDX(W, E)];
+    assert(A_old == W->Es.As[TNECS_E_IDX(W, E)]);
 
-    assert(E_O_old < W->byA.len_Es[A_old_id]);
-    assert(W->byA.Es[A_old_id][E_O_old] == E);
+    assert(E_O_old < W->byA.arr[A_old_id].len_Es);
+    assert(W->byA.arr[A_old_id].Es[E_O_old] == E);
 
-    tnecs_E top_E = W->byA.Es[A_old_id][old_num - 1];
+    tnecs_E top_E = W->byA.arr[A_old_id].Es[old_num - 1];
 
     /* Cs scrambles -> EsbyA too */
-    TNECS_CHECK(tnecs_arrdel(W->byA.Es[A_old_id], E_O_old, 
-                             old_num, sizeof(**W->byA.Es)));
+    TNECS_CHECK(tnecs_arrdel(W->byA.arr[A_old_id].Es, E_O_old, 
+                             old_num, sizeof(tnecs_E)));
 
     if (top_E != E) {
-        W->Es.Os[top_E] = E_O_old;
-        assert(W->byA.Es[A_old_id][E_O_old] == top_E);
+        W->counts.bytes_copied += sizeof(tnecs_E);
+        W->Es.Os[TNECS_E_IDX(W, top_E)] = E_O_old;
+        assert(W->byA.arr[A_old_id].Es[E_O_old] == top_E);
     }
 
-    W->Es.Os[E] = TNECS_NULL;
-    W->Es.As[E] = TNECS_NULL;
+    W->Es.Os[TNECS_E_IDX(W, E)] = TNECS_NULL;
+    W->Es.As[TNECS_E_IDX(W, E)] = TNECS_NULL;
 
-    --W->byA.num_Es[A_old_id];
+    --W->byA.arr[A_old_id].num_Es;
     return (1);
 }
 
 int tnecs_EsbyA_migrate(tnecs_W    *W, tnecs_E E,
                         tnecs_C A_old, tnecs_C A_new) {
     /* Migrate Es into correct byA array */
+    if (A_old != TNECS_NULL)
+        W->counts.migrations++;
     TNECS_CHECK(tnecs_EsbyA_del(W, E, A_old));
-    assert(W->Es.As[E]  == TNECS_NULL);
-    assert(W->Es.Os[E]  == TNECS_NULL);
+    assert(W->Es.As[TNECS_E_IDX(W, E)]  == TNECS_NULL);
+    assert(W->Es.Os[TNECS_E_IDX(W, E)]  == TNECS_NULL);
     TNECS_CHECK(tnecs_EsbyA_add(W, E, A_new));
 
 #ifndef NDEBUG
     size_t tID_new  = tnecs_A_id(W, A_new);
-    size_t O_new    = W->Es.Os[E];
-    assert(W->Es.As[E]                  == A_new);
-    assert(W->byA.num_Es[tID_new] - 1   == O_new);
-    assert(W->byA.Es[tID_new][O_new]    == E);
+    size_t O_new    = W->Es.Os[TNECS_E_IDX(W, E)];
+    assert(W->Es.As[TNECS_E_IDX(W, E)]                  == A_new);
+    assert(W->byA.arr[tID_new].num_Es - 1   == O_new);
+    assert(W->byA.arr[tID_new].Es[O_new]    == E);
 #endif /* NDEBUG */
     return (1);
 }
@@ -1071,16 +2978,18 @@ int tnecs_EsbyA_migrate(tnecs_W    *W, tnecs_E E,
 int tnecs_C_add(tnecs_W *W, tnecs_C A) {
     /* Check if need to grow component array after adding new component */
     size_t tID          = tnecs_A_id(W, A);
-    size_t new_C_num = W->byA.num_Cs[tID];
+    size_t new_C_num = W->byA.arr[tID].num_Cs;
 #ifndef NDEBUG
-    size_t E_O = W->byA.num_Es[tID];
+    size_t E_O = W->byA.arr[tID].num_Es;
 #endif /* NDEBUG */
 
     for (size_t C_O = 0; C_O < new_C_num; C_O++) {
         /* Take component array of current A_id */
-        tnecs_C_arr *C_arr = &W->byA.Cs[tID][C_O];
+        tnecs_C_arr *C_arr = &W->byA.arr[tID].Cs[C_O];
         /* check if it need to grow after adding new component */
         assert(E_O == C_arr->num);
+        size_t C_id = W->byA.arr[tID].Cs_id[C_O];
+        TNECS_CHECK(tnecs_C_own(W, C_arr, W->Cs.bytesizes[C_id]));
 
         if (++C_arr->num >= C_arr->len)
             TNECS_CHECK(tnecs_grow_C_array(W, C_arr, tID, C_O));
@@ -1097,15 +3006,15 @@ int tnecs_C_copy(tnecs_W *W,    tnecs_E E,
 
     size_t old_tID      = tnecs_A_id(W, old_A);
     size_t new_tID      = tnecs_A_id(W, new_A);
-    size_t old_E_O      = W->Es.Os[E];
-    size_t new_E_O      = W->byA.num_Es[new_tID];
-    size_t num_C_new    = W->byA.num_Cs[new_tID];
-    size_t num_C_old    = W->byA.num_Cs[old_tID];
+    size_t old_E_O      = W->Es.Os[TNECS_E_IDX(W, E)];
+    size_t new_E_O      = W->byA.arr[new_tID].num_Es;
+    size_t num_C_new    = W->byA.arr[new_tID].num_Cs;
+    size_t num_C_old    = W->byA.arr[old_tID].num_Cs;
 
 #ifndef NDEBUG
     /* Sanity check: entity order is the same in new Cs array */
-    for (int i = 0; i < num_C_new; ++i) {
-        size_t num = W->byA.Cs[new_tID][i].num;
+    for (size_t i = 0; i < num_C_new; ++i) {
+        size_t num = W->byA.arr[new_tID].Cs[i].num;
         assert((num - 1) == new_E_O);
     }
 #endif /* NDEBUG */
@@ -1116,14 +3025,14 @@ int tnecs_C_copy(tnecs_W *W,    tnecs_E E,
     tnecs_byte  *old_C_arr, *new_C_arr;
 
     for (size_t old_C_O = 0; old_C_O < num_C_old; old_C_O++) {
-        old_C_id = W->byA.Cs_id[old_tID][old_C_O];
+        old_C_id = W->byA.arr[old_tID].Cs_id[old_C_O];
         for (size_t new_C_O = 0; new_C_O < num_C_new; new_C_O++) {
-            new_C_id = W->byA.Cs_id[new_tID][new_C_O];
+            new_C_id = W->byA.arr[new_tID].Cs_id[new_C_O];
             if (old_C_id != new_C_id)
                 continue;
 
-            new_array = &W->byA.Cs[new_tID][new_C_O];
-            old_arr = &W->byA.Cs[old_tID][old_C_O];
+            new_array = &W->byA.arr[new_tID].Cs[new_C_O];
+            old_arr = &W->byA.arr[old_tID].Cs[old_C_O];
             assert(old_arr->type == new_array->type);
             assert(old_arr != new_array);
 
@@ -1131,7 +3040,7 @@ int tnecs_C_copy(tnecs_W *W,    tnecs_E E,
             assert(C_bytesize > 0);
 
             old_C_arr = (tnecs_byte *)(old_arr->Cs);
-            assert(old_C != NULL);
+            assert(old_C_arr != NULL);
 
             old_C = (old_C_arr + (C_bytesize * old_E_O));
             assert(old_C != NULL);
@@ -1149,6 +3058,7 @@ int tnecs_C_copy(tnecs_W *W,    tnecs_E E,
 #else
             memmove(new_C, old_C, C_bytesize);
 #endif /* NDEBUG */
+            W->counts.bytes_copied += C_bytesize;
             break;
         }
     }
@@ -1158,9 +3068,9 @@ int tnecs_C_copy(tnecs_W *W,    tnecs_E E,
 int tnecs_C_run(tnecs_W *W, tnecs_E          E,
                 tnecs_C  A, tnecs_init_f    *funcs) {
     size_t tID      = tnecs_A_id(W, A);
-    size_t C_num    = W->byA.num_Cs[tID];
+    size_t C_num    = W->byA.arr[tID].num_Cs;
     for (size_t C_O = 0; C_O < C_num; C_O++) {
-        size_t C_id = W->byA.Cs_id[tID][C_O];
+        size_t C_id = W->byA.arr[tID].Cs_id[C_O];
         tnecs_init_f func = funcs[C_id]; 
         if (func == NULL) {
             continue;
@@ -1185,20 +3095,23 @@ int tnecs_C_free(tnecs_W *W, tnecs_E E, tnecs_C A) {
 int tnecs_C_del(tnecs_W *W, tnecs_E E, tnecs_C old_A) {
     /* Delete ALL Cs from CsbyA at old entity order */
     size_t old_tID      = tnecs_A_id(W, old_A);
-    size_t O_old        = W->Es.Os[E];
-    size_t old_C_num    = W->byA.num_Cs[old_tID];
+    size_t O_old        = W->Es.Os[TNECS_E_IDX(W, E)];
+    size_t old_C_num    = W->byA.arr[old_tID].num_Cs;
     for (size_t C_O = 0; C_O < old_C_num; C_O++) {
-        size_t      C_id        = W->byA.Cs_id[old_tID][C_O];
-        tnecs_C_arr *old_arr    = &W->byA.Cs[old_tID][C_O];
+        size_t      C_id        = W->byA.arr[old_tID].Cs_id[C_O];
+        tnecs_C_arr *old_arr    = &W->byA.arr[old_tID].Cs[C_O];
+        size_t       C_by       = W->Cs.bytesizes[C_id];
+        TNECS_CHECK(tnecs_C_own(W, old_arr, C_by));
         tnecs_byte  *C          = old_arr->Cs;
         assert(C != NULL);
 
         /* Scramble Cs too */
-        size_t C_by       = W->Cs.bytesizes[C_id];
-        size_t new_C_num  = W->byA.num_Es[old_tID];
+        size_t new_C_num  = W->byA.arr[old_tID].num_Es;
         const tnecs_byte *scramble;
         scramble = tnecs_arrdel(C, O_old, new_C_num, C_by);
         TNECS_CHECK(scramble);
+        if (O_old != (new_C_num - 1))
+            W->counts.bytes_copied += C_by;
 
         old_arr->num--;
     }
@@ -1207,7 +3120,7 @@ int tnecs_C_del(tnecs_W *W, tnecs_E E, tnecs_C old_A) {
 
 int tnecs_C_migrate(tnecs_W *W,     tnecs_E E,
                     tnecs_C  old_A, tnecs_C new_A) {
-    if (old_A != W->Es.As[E]) {
+    if (old_A != W->Es.As[TNECS_E_IDX(W, E)]) {
         return (0);
     }
     TNECS_CHECK(tnecs_C_add(W,  new_A));
@@ -1219,11 +3132,15 @@ int tnecs_C_migrate(tnecs_W *W,     tnecs_E E,
 }
 
 int tnecs_C_arr_new(tnecs_W *W, size_t num_Cs, tnecs_C A) {
-    tnecs_C_arr *C_arr = calloc(num_Cs, sizeof(tnecs_C_arr));
+    /* One block: columns, then their C_ids */
+    tnecs_C_arr *C_arr = tnecs_calloc(W, num_Cs, TNECS_ARCH_C_BYTES);
     TNECS_CHECK(C_arr);
 
     tnecs_C A_reduced = A, A_added = 0;
     tnecs_C tID     = tnecs_A_id(W, A);
+    tnecs_Arch *arch = &W->byA.arr[tID];
+    arch->Cs        = C_arr;
+    arch->Cs_id     = (tnecs_C *)(C_arr + num_Cs);
     size_t id_toadd = 0, num_flags = 0;
 
     while (A_reduced) {
@@ -1234,10 +3151,11 @@ int tnecs_C_arr_new(tnecs_W *W, size_t num_Cs, tnecs_C A) {
         assert(id_toadd > 0);
         assert(id_toadd < W->Cs.num);
         TNECS_CHECK(tnecs_C_arr_init(W, &C_arr[num_flags], id_toadd));
+        arch->Cs_id[num_flags]  = id_toadd;
+        arch->Cs_O[id_toadd]    = (unsigned char)num_flags;
         num_flags++;
         A_added += type_toadd;
     }
-    W->byA.Cs[tID] = C_arr;
     assert(id_toadd < W->Cs.num);
     return ((A_added == A) && (num_flags == num_Cs));
 }
@@ -1254,8 +3172,8 @@ int tnecs_C_arr_init(   tnecs_W *W, tnecs_C_arr  *C_arr,
 
     C_arr->type  = in_type;
     C_arr->num   = 0;
-    C_arr->len   = TNECS_C_0LEN;
-    C_arr->Cs    = calloc(TNECS_C_0LEN, bytesize);
+    C_arr->len   = W->config.len_C;
+    C_arr->Cs    = tnecs_calloc(W, C_arr->len, bytesize);
     TNECS_CHECK(C_arr->Cs);
     return (1);
 }
@@ -1269,8 +3187,8 @@ size_t tnecs_C_O_byA(   const tnecs_W *const W,
 
 size_t tnecs_C_O_byAid( const tnecs_W *const W,
                         size_t C_id, size_t tID) {
-    for (size_t i = 0; i < W->byA.num_Cs[tID]; i++) {
-        if (W->byA.Cs_id[tID][i] == C_id) {
+    for (size_t i = 0; i < W->byA.arr[tID].num_Cs; i++) {
+        if (W->byA.arr[tID].Cs_id[i] == C_id) {
             return(i);
         }
     }
@@ -1291,7 +3209,7 @@ tnecs_C tnecs_C_ids2A(size_t argnum, ...) {
 
 tnecs_C tnecs_A_id(const tnecs_W *const W, tnecs_C A) {
     for (size_t i = 0; i < W->byA.num; i++) {
-        if (A == W->byA.A[i]) {
+        if (A == W->byA.arr[i].A) {
             return(i);
         }
     }
@@ -1299,19 +3217,76 @@ tnecs_C tnecs_A_id(const tnecs_W *const W, tnecs_C A) {
 }
 
 /***************** "DYNAMIC" ARRAYS ******************/
-void *tnecs_realloc(void   *ptr,  size_t olen,
-                    size_t  nlen, size_t elem_bytesize) {
-    if (!ptr)
+size_t tnecs_grow_len(const tnecs_W *W, size_t olen, size_t min) {
+    /* Geometric growth, linear once len >= config.linear */
+    size_t nlen     = olen;
+    size_t linear   = W->config.linear;
+    while (nlen < min) {
+        size_t grown = (size_t)((double)nlen * W->config.grow);
+        if ((linear > 0) && (nlen >= linear))
+            grown = nlen + linear;
+        nlen = (grown > nlen) ? grown : (nlen + 1);
+    }
+    return (nlen);
+}
+
+void *tnecs_std_alloc(void *ctx, size_t bytes) {
+    (void)ctx;
+    return (calloc(1, bytes));
+}
+
+void tnecs_std_free(void *ctx, void *ptr, size_t bytes) {
+    (void)ctx;
+    (void)bytes;
+    free(ptr);
+}
+
+void *tnecs_calloc(tnecs_W *W, size_t num, size_t bytesize) {
+    /* Zeroed, never 0 bytes. Locked: never */
+    if (W->locked) {
+        W->counts.rejects++;
+        return (NULL);
+    }
+    size_t bytes = num * bytesize;
+    return (W->alloc.alloc(W->alloc.ctx, (bytes > 0) ? bytes : 1));
+}
+
+void tnecs_free(const tnecs_W *W, void *ptr, size_t bytes) {
+    if (ptr != NULL)
+        W->alloc.free(W->alloc.ctx, ptr, (bytes > 0) ? bytes : 1);
+}
+
+void *tnecs_realloc(tnecs_W *W,    void   *ptr,
+                    size_t   olen, size_t  nlen,
+                    size_t   elem_bytesize) {
+    /* Lazy arrays: first growth allocates */
+    if (ptr == NULL)
+        return (tnecs_calloc(W, nlen, elem_bytesize));
+    if (W->locked) {
+        W->counts.rejects++;
         return (NULL);
-    void *realloced = calloc(nlen, elem_bytesize);
-    TNECS_CHECK(realloced);
-    if (realloced == NULL) {
-        printf("tnecs: failed allocation realloced\n");
-        return(NULL);
     }
     size_t elen = (nlen > olen ? olen : nlen);
-    memcpy(realloced, ptr, elen * elem_bytesize);
-    free(ptr);
+    void *realloced;
+    if ((W->alloc.realloc != NULL) && !tnecs_mapped(W, ptr)) {
+        /* Allocator realloc: zero new elements */
+        realloced = W->alloc.realloc(W->alloc.ctx, ptr,
+                                     olen * elem_bytesize,
+                                     nlen * elem_bytesize);
+        TNECS_CHECK(realloced);
+        tnecs_byte *bytes = realloced;
+        memset(bytes + elen * elem_bytesize, 0,
+               (nlen - elen) * elem_bytesize);
+    } else {
+        realloced = tnecs_calloc(W, nlen, elem_bytesize);
+        TNECS_CHECK(realloced);
+        memcpy(realloced, ptr, elen * elem_bytesize);
+        /* Mapped arrays: copied on growth, never freed */
+        if (!tnecs_mapped(W, ptr))
+            tnecs_free(W, ptr, olen * elem_bytesize);
+    }
+    W->counts.reallocs++;
+    W->counts.bytes_copied += elen * elem_bytesize;
     return (realloced);
 }
 
@@ -1331,17 +3306,20 @@ void *tnecs_arrdel(void *arr,  size_t elem,
 int tnecs_grow_ran(tnecs_W *W) {
     /* Realloc Ss ran if too many */
     size_t olen         = W->Ss.ran.len;
-    size_t nlen         = olen * TNECS_ARR_GROW;
-    W->Ss.ran.len       = nlen;
-    W->Ss.to_run.len    = nlen;
+    size_t nlen         = tnecs_grow_len(W, olen, olen + 1);
     size_t bytesize     = sizeof(tnecs_S_f);
 
-    W->Ss.ran.arr       = tnecs_realloc(W->Ss.ran.arr, 
+    /* Failed growth: old arrays & len kept */
+    void *ran           = tnecs_realloc(W, W->Ss.ran.arr,
                                         olen, nlen, bytesize);
-    W->Ss.to_run.arr    = tnecs_realloc(W->Ss.to_run.arr, 
+    TNECS_CHECK(ran);
+    W->Ss.ran.arr       = ran;
+    void *to_run        = tnecs_realloc(W, W->Ss.to_run.arr,
                                         olen, nlen, bytesize);
-    TNECS_CHECK(W->Ss.ran.arr);
-    TNECS_CHECK(W->Ss.to_run.arr);
+    TNECS_CHECK(to_run);
+    W->Ss.to_run.arr    = to_run;
+    W->Ss.ran.len       = nlen;
+    W->Ss.to_run.len    = nlen;
     return (1);
 }
 #endif /* NDEBUG */
@@ -1349,208 +3327,308 @@ int tnecs_grow_ran(tnecs_W *W) {
 int tnecs_grow_Es_open(tnecs_W *W) {
     /* Realloc Es_open if too many */
     if ((W->Es.open.num + 1) >= W->Es.open.len) {
+        TNECS_TRACE_B(W, TNECS_TRACE_GROW_OPEN, W->Es.open.len, 0);
         size_t olen     = W->Es.open.len;
-        size_t nlen     = olen * TNECS_ARR_GROW;
+        size_t nlen     = tnecs_grow_len(W, olen, olen + 1);
         size_t bytesize = sizeof(tnecs_E);
-        W->Es.open.len  = nlen;
 
-        W->Es.open.arr  = tnecs_realloc(W->Es.open.arr, 
+        tnecs_E *arr    = tnecs_realloc(W, W->Es.open.arr,
                                         olen, nlen, bytesize);
-        TNECS_CHECK(W->Es.open.arr);
+        TNECS_CHECK(arr);
+        W->Es.open.arr  = arr;
+        W->Es.open.len  = nlen;
+        TNECS_TRACE_E(W, TNECS_TRACE_GROW_OPEN, olen, 0);
     }
     return (1);
 }
 
 int tnecs_grow_C_array( tnecs_W *W, tnecs_C_arr *C_arr,
                         size_t tID, size_t      C_O) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_C, tID, C_O);
+    size_t C_id     = W->byA.arr[tID].Cs_id[C_O];
+    size_t bytesize = W->Cs.bytesizes[C_id];
+    /* Never realloc a column shared with clones */
+    TNECS_CHECK(tnecs_C_own(W, C_arr, bytesize));
     size_t olen = C_arr->len;
-    size_t nlen = olen * TNECS_ARR_GROW;
-    C_arr->len  = nlen;
-    size_t C_id  = W->byA.Cs_id[tID][C_O];
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
 
-    size_t bytesize = W->Cs.bytesizes[C_id];
-    C_arr->Cs = tnecs_realloc(C_arr->Cs, olen, nlen, bytesize);
-    TNECS_CHECK(C_arr->Cs);
+    void *Cs    = tnecs_realloc(W, C_arr->Cs, olen, nlen, bytesize);
+    TNECS_CHECK(Cs);
+    C_arr->Cs   = Cs;
+    C_arr->len  = nlen;
+    W->plan.stale = 1;
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_C, tID, C_O);
     return (1);
 }
 
 int tnecs_grow_E(tnecs_W *W) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_E, W->Es.len, 0);
     size_t olen = W->Es.len;
-    size_t nlen = W->Es.len * TNECS_ARR_GROW;
-    W->Es.len = nlen;
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
     if (nlen >= TNECS_E_CAP) {
         printf("tnecs: Es cap reached\n");
         return (TNECS_NULL);
     }
+    TNECS_CHECK(tnecs_grow_Es(W, olen, nlen));
 
-    W->Es.id    = tnecs_realloc(W->Es.id, olen, nlen,
-                                sizeof(*W->Es.id));
-    TNECS_CHECK(W->Es.id);
-    W->Es.Os    = tnecs_realloc(W->Es.Os, olen, nlen,
-                                sizeof(*W->Es.Os));
-    TNECS_CHECK(W->Es.Os);
-    W->Es.As    = tnecs_realloc(W->Es.As, olen, nlen,
-                                sizeof(*W->Es.As));
-    TNECS_CHECK(W->Es.As);
-
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_E, olen, 0);
     return (1);
 }
 
 int tnecs_grow_S(tnecs_W *W) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_S, W->Ss.len, 0);
     size_t olen = W->Ss.len;
-    size_t nlen = olen * TNECS_ARR_GROW;
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
     assert(olen > 0);
-    W->Ss.len   = nlen;
-
-    W->Ss.Phs   = tnecs_realloc(W->Ss.Phs, olen, nlen,
-                                sizeof(*W->Ss.Phs));
-    TNECS_CHECK(W->Ss.Phs);
-    W->Ss.Os    = tnecs_realloc(W->Ss.Os, olen, nlen,
-                                sizeof(*W->Ss.Os));
-    TNECS_CHECK(W->Ss.Os);
-    W->Ss.Ex    = tnecs_realloc(W->Ss.Ex, olen, nlen,
-                                sizeof(*W->Ss.Ex));
-    TNECS_CHECK(W->Ss.Pi);
-    W->Ss.Pi    = tnecs_realloc(W->Ss.Pi, olen, nlen,
-                                sizeof(*W->Ss.Pi));
-    TNECS_CHECK(W->Ss.Ex);
-    W->Ss.As    = tnecs_realloc(W->Ss.As, olen, nlen,
-                                sizeof(*W->Ss.As));
-    TNECS_CHECK(W->Ss.As);
 
+    void *arr = tnecs_realloc(W, W->Ss.Phs, olen, nlen, sizeof(*W->Ss.Phs));
+    TNECS_CHECK(arr);
+    W->Ss.Phs = arr;
+    arr = tnecs_realloc(W, W->Ss.Os, olen, nlen, sizeof(*W->Ss.Os));
+    TNECS_CHECK(arr);
+    W->Ss.Os = arr;
+    arr = tnecs_realloc(W, W->Ss.Ex, olen, nlen, sizeof(*W->Ss.Ex));
+    TNECS_CHECK(arr);
+    W->Ss.Ex = arr;
+    arr = tnecs_realloc(W, W->Ss.Pi, olen, nlen, sizeof(*W->Ss.Pi));
+    TNECS_CHECK(arr);
+    W->Ss.Pi = arr;
+    arr = tnecs_realloc(W, W->Ss.As, olen, nlen, sizeof(*W->Ss.As));
+    TNECS_CHECK(arr);
+    W->Ss.As = arr;
+    arr = tnecs_realloc(W, W->Ss.batch, olen, nlen, sizeof(*W->Ss.batch));
+    TNECS_CHECK(arr);
+    W->Ss.batch = arr;
+    arr = tnecs_realloc(W, W->Ss.plan_O, olen, nlen,
+                        sizeof(*W->Ss.plan_O));
+    TNECS_CHECK(arr);
+    W->Ss.plan_O = arr;
+    arr = tnecs_realloc(W, W->Ss.plan_num, olen, nlen,
+                        sizeof(*W->Ss.plan_num));
+    TNECS_CHECK(arr);
+    W->Ss.plan_num = arr;
+#ifdef TNECS_PROFILE
+    arr = tnecs_realloc(W, W->Ss.prof, olen, nlen, sizeof(*W->Ss.prof));
+    TNECS_CHECK(arr);
+    W->Ss.prof = arr;
+#endif /* TNECS_PROFILE */
+    W->Ss.len = nlen;
+
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_S, olen, 0);
     return (1);
 }
 
 int tnecs_grow_A(tnecs_W *W) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_A, W->byA.len, 0);
     size_t olen = W->byA.len;
-    size_t nlen = olen * TNECS_ARR_GROW;
-    W->byA.len  = nlen;
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
 
-    W->byA.A       = tnecs_realloc(W->byA.A, olen, nlen, 
-                                    sizeof(*W->byA.A));
-    W->byA.Es       = tnecs_realloc(W->byA.Es, olen, nlen,
-                                    sizeof(*W->byA.Es));
-    W->byA.num_Es   = tnecs_realloc(W->byA.num_Es, olen, nlen,
-                                    sizeof(*W->byA.num_Es));
-    W->byA.len_Es   = tnecs_realloc(W->byA.len_Es, olen, nlen,
-                                    sizeof(*W->byA.len_Es));
-    W->byA.subA     = tnecs_realloc(W->byA.subA, olen, nlen,
-                                    sizeof(*W->byA.subA));
-    W->byA.Cs_id    = tnecs_realloc(W->byA.Cs_id, olen, nlen,
-                                    sizeof(*W->byA.Cs_id));
-    W->byA.num_Cs   = tnecs_realloc(W->byA.num_Cs, olen, nlen,
-                                    sizeof(*W->byA.num_Cs));
-    W->byA.Cs_O     = tnecs_realloc(W->byA.Cs_O, olen, nlen,
-                                    sizeof(*W->byA.Cs_O));
-    W->byA.num_A_ids = tnecs_realloc(W->byA.num_A_ids, olen, nlen,
-                                    sizeof(*W->byA.num_A_ids));
-    W->byA.Cs        = tnecs_realloc(W->byA.Cs, olen, nlen,
-                                    sizeof(*W->byA.Cs));
-
-    TNECS_CHECK(W->byA.A);
-    TNECS_CHECK(W->byA.Es);
-    TNECS_CHECK(W->byA.num_Es);
-    TNECS_CHECK(W->byA.subA);
-    TNECS_CHECK(W->byA.len_Es);
-    TNECS_CHECK(W->byA.Cs_id);
-    TNECS_CHECK(W->byA.num_Cs);
-    TNECS_CHECK(W->byA.Cs_O);
-    TNECS_CHECK(W->byA.num_A_ids);
-    TNECS_CHECK(W->byA.Cs);
-
-    for (size_t i = olen; i < W->byA.len; i++) {
-        W->byA.Es[i]    = calloc(TNECS_E_0LEN, sizeof(**W->byA.Es));
-        W->byA.subA[i]  = calloc(TNECS_C_CAP, sizeof(**W->byA.subA));
-        TNECS_CHECK(W->byA.Es[i]);
-        TNECS_CHECK(W->byA.subA[i]);
-
-        W->byA.len_Es[i] = TNECS_E_0LEN;
-        W->byA.num_Es[i] = 0;
-    }
+    tnecs_Arch *arr = tnecs_realloc(W, W->byA.arr, olen, nlen,
+                                    sizeof(*W->byA.arr));
+    TNECS_CHECK(arr);
+    W->byA.arr  = arr;
+    W->byA.len  = nlen;
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_A, olen, 0);
     return (1);
 }
 
 int tnecs_grow_Pi(tnecs_W *W) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_Pi, W->Pis.len, 0);
     size_t olen = W->Pis.len;
-    size_t nlen = olen * TNECS_ARR_GROW;
-    W->Pis.len = nlen;
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
     if (nlen >= TNECS_Pi_CAP) {
         printf("tnecs: Pis cap reached\n");
         return (TNECS_NULL);
     }
 
-    W->Pis.byPh = tnecs_realloc(W->Pis.byPh, olen, nlen,
-                                sizeof(*W->Pis.byPh));
-    TNECS_CHECK(W->Pis.byPh);
+    tnecs_Phs *byPh = tnecs_realloc(W, W->Pis.byPh, olen, nlen,
+                                    sizeof(*W->Pis.byPh));
+    TNECS_CHECK(byPh);
+    W->Pis.byPh = byPh;
+    W->Pis.len  = nlen;
+
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_Pi, olen, 0);
+    return (1);
+}
+
+int tnecs_grow_plan(tnecs_W *W, size_t len) {
+    tnecs_Plan *plan = &W->plan;
+    size_t olen = plan->len;
+    size_t nlen = tnecs_grow_len(W, olen, len);
+
+    void *arr = tnecs_realloc(W, plan->Ss, olen, nlen, sizeof(*plan->Ss));
+    TNECS_CHECK(arr);
+    plan->Ss = arr;
+    arr = tnecs_realloc(W, plan->Ss_id, olen, nlen, sizeof(*plan->Ss_id));
+    TNECS_CHECK(arr);
+    plan->Ss_id = arr;
+    arr = tnecs_realloc(W, plan->tables, olen, nlen,
+                        sizeof(*plan->tables));
+    TNECS_CHECK(arr);
+    plan->tables = arr;
+    plan->len = nlen;
 
     return (1);
 }
 
 int tnecs_grow_Ph(tnecs_W *W, tnecs_Pi Pi) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_Ph, Pi, 0);
     tnecs_Phs *byPh = TNECS_Pi_GET(W, Pi);
     size_t olen = byPh->len;
-    size_t nlen = olen * TNECS_ARR_GROW;
-    byPh->len = nlen;
+    size_t nlen = tnecs_grow_len(W, olen, olen + 1);
     if (nlen >= TNECS_Ph_CAP) {
         printf("tnecs: Phs cap reached\n");
         return (TNECS_NULL);
     }
 
-    byPh->Ss      = tnecs_realloc(  byPh->Ss, olen, nlen,
-                                    sizeof(*byPh->Ss));
-    byPh->Ss_id   = tnecs_realloc(  byPh->Ss_id, olen, nlen,
-                                    sizeof(*byPh->Ss_id));
-    byPh->len_Ss  = tnecs_realloc(  byPh->len_Ss, olen, nlen,
-                                    sizeof(*byPh->len_Ss));
-    byPh->num_Ss  = tnecs_realloc(  byPh->num_Ss, olen, nlen,
-                                    sizeof(*byPh->num_Ss));
-    TNECS_CHECK(byPh->Ss);
-    TNECS_CHECK(byPh->Ss_id);
-    TNECS_CHECK(byPh->len_Ss);
-    TNECS_CHECK(byPh->num_Ss);
-
-    for (size_t i = olen; i < byPh->len; i++) {
-        size_t bytesize1 = sizeof(**byPh->Ss);
-        size_t bytesize2 = sizeof(**byPh->Ss_id);
-
-        byPh->Ss[i]     = calloc(TNECS_Ph_0LEN, bytesize1);
-        byPh->Ss_id[i]  = calloc(TNECS_Ph_0LEN, bytesize2);
-        TNECS_CHECK(byPh->Ss[i]);
-        TNECS_CHECK(byPh->Ss_id[i]);
-
-        byPh->len_Ss[i] = TNECS_Ph_0LEN;
-        byPh->num_Ss[i] = 0;
-    }
+    void *arr = tnecs_realloc(W, byPh->Ss, olen, nlen, sizeof(*byPh->Ss));
+    TNECS_CHECK(arr);
+    byPh->Ss = arr;
+    arr = tnecs_realloc(W, byPh->Ss_id, olen, nlen, sizeof(*byPh->Ss_id));
+    TNECS_CHECK(arr);
+    byPh->Ss_id = arr;
+    arr = tnecs_realloc(W, byPh->len_Ss, olen, nlen,
+                        sizeof(*byPh->len_Ss));
+    TNECS_CHECK(arr);
+    byPh->len_Ss = arr;
+    arr = tnecs_realloc(W, byPh->num_Ss, olen, nlen,
+                        sizeof(*byPh->num_Ss));
+    TNECS_CHECK(arr);
+    byPh->num_Ss = arr;
+    byPh->len = nlen;
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_Ph, Pi, 0);
     return (1);
 }
 
-int tnecs_grow_S_byPh(tnecs_Phs *byPh, tnecs_Ph Ph) {
+int tnecs_grow_S_byPh(tnecs_W *W, tnecs_Phs *byPh, tnecs_Ph Ph) {
     size_t olen         = byPh->len_Ss[Ph];
-    size_t nlen         = olen * TNECS_ARR_GROW;
-    byPh->len_Ss[Ph]    = nlen;
+    size_t nlen         = (olen > 0) ? tnecs_grow_len(W, olen, olen + 1) :
+                                       TNECS_Ph_0LEN;
     size_t bs           = sizeof(**byPh->Ss);
     size_t bsid         = sizeof(**byPh->Ss_id);
 
-    tnecs_S_f *Ss   = byPh->Ss[Ph];
-    size_t *S_id    = byPh->Ss_id[Ph];
-    byPh->Ss[Ph]    = tnecs_realloc(Ss, olen, nlen, bs);
-    byPh->Ss_id[Ph] = tnecs_realloc(S_id, olen, nlen, bsid);
-    TNECS_CHECK(byPh->Ss[Ph]);
-    TNECS_CHECK(byPh->Ss_id[Ph]);
+    tnecs_S_f *Ss   = tnecs_realloc(W, byPh->Ss[Ph], olen, nlen, bs);
+    TNECS_CHECK(Ss);
+    byPh->Ss[Ph]    = Ss;
+    size_t *S_id    = tnecs_realloc(W, byPh->Ss_id[Ph], olen, nlen, bsid);
+    TNECS_CHECK(S_id);
+    byPh->Ss_id[Ph] = S_id;
+    byPh->len_Ss[Ph] = nlen;
     return (1);
 }
 
-int tnecs_grow_byA(tnecs_W *W, size_t tID) {
-    size_t olen = W->byA.len_Es[tID];
-    size_t nlen = olen * TNECS_ARR_GROW;
+int tnecs_grow_subA(tnecs_W *W, size_t tID, size_t subA_id) {
+    /* Append subA_id to subA of tID, realloc if full */
+    tnecs_Arch *arch = &W->byA.arr[tID];
+    if (arch->num_A_ids >= arch->len_A_ids) {
+        size_t olen     = arch->len_A_ids;
+        size_t nlen     = (olen > 0) ? tnecs_grow_len(W, olen, olen + 1) :
+                                       TNECS_subA_0LEN;
+        size_t *subA    = tnecs_realloc(W, arch->subA, olen, nlen,
+                                        sizeof(*arch->subA));
+        TNECS_CHECK(subA);
+        arch->subA      = subA;
+        arch->len_A_ids = nlen;
+    }
+    arch->subA[arch->num_A_ids++] = subA_id;
+    return (1);
+}
 
-    assert(olen > 0);
-    W->byA.len_Es[tID] = nlen;
+int tnecs_reserve_E(tnecs_W *W, size_t len) {
+    /* Grow Es table to at least len */
+    if (len <= W->Es.len)
+        return (1);
+    TNECS_CHECK(len < TNECS_E_CAP);
+    return (tnecs_grow_Es(W, W->Es.len, len));
+}
 
-    size_t bytesize = sizeof(*W->byA.Es[tID]);
-    tnecs_E *ptr    = W->byA.Es[tID];
-    W->byA.Es[tID]  = tnecs_realloc(ptr, olen, nlen, bytesize);
-    TNECS_CHECK(W->byA.Es[tID]);
+int tnecs_grow_Es(tnecs_W *W, size_t olen, size_t nlen) {
+    /* Es table grown array by array: Es.len kept on failure */
+    TNECS_CHECK(tnecs_grow_Es_aux(W, olen, nlen));
+    void *arr = tnecs_realloc(W, W->Es.id, olen, nlen, sizeof(*W->Es.id));
+    TNECS_CHECK(arr);
+    W->Es.id = arr;
+    arr = tnecs_realloc(W, W->Es.Os, olen, nlen, sizeof(*W->Es.Os));
+    TNECS_CHECK(arr);
+    W->Es.Os = arr;
+    arr = tnecs_realloc(W, W->Es.As, olen, nlen, sizeof(*W->Es.As));
+    TNECS_CHECK(arr);
+    W->Es.As = arr;
+    W->Es.len = nlen;
+    return (1);
+}
+
+int tnecs_grow_Es_aux(tnecs_W *W, size_t olen, size_t nlen) {
+    /* Open bits & generations follow Es table */
+    size_t obits = TNECS_BITS_LEN(olen), nbits = TNECS_BITS_LEN(nlen);
+    void *arr;
+    if (obits != nbits) {
+        arr = tnecs_realloc(W, W->Es.isOpen, obits, nbits,
+                            sizeof(*W->Es.isOpen));
+        TNECS_CHECK(arr);
+        W->Es.isOpen = arr;
+    }
+    if (W->Es.gen != NULL) {
+        arr = tnecs_realloc(W, W->Es.gen, olen, nlen, sizeof(*W->Es.gen));
+        TNECS_CHECK(arr);
+        W->Es.gen = arr;
+    }
+    return (1);
+}
+
+int tnecs_reserve_open(tnecs_W *W, size_t len) {
+    /* Grow Es_open to at least len */
+    if (len <= W->Es.open.len)
+        return (1);
+    size_t olen     = W->Es.open.len;
+    tnecs_E *arr    = tnecs_realloc(W, W->Es.open.arr, olen, len,
+                                    sizeof(tnecs_E));
+    TNECS_CHECK(arr);
+    W->Es.open.arr  = arr;
+    W->Es.open.len  = len;
+    return (1);
+}
+
+int tnecs_reserve_byA(tnecs_W *W, size_t tID, size_t len) {
+    /* Grow Es & columns of archetype to at least len */
+    if (len > W->byA.arr[tID].len_Es) {
+        size_t olen     = W->byA.arr[tID].len_Es;
+        tnecs_E *Es     = tnecs_realloc(W, W->byA.arr[tID].Es, olen, len,
+                                        sizeof(tnecs_E));
+        TNECS_CHECK(Es);
+        W->byA.arr[tID].Es      = Es;
+        W->byA.arr[tID].len_Es  = len;
+    }
+    for (size_t C_O = 0; C_O < W->byA.arr[tID].num_Cs; C_O++) {
+        tnecs_C_arr *C_arr = &W->byA.arr[tID].Cs[C_O];
+        if (len <= C_arr->len)
+            continue;
+        size_t C_id = W->byA.arr[tID].Cs_id[C_O];
+        TNECS_CHECK(tnecs_C_own(W, C_arr, W->Cs.bytesizes[C_id]));
+        void *Cs    = tnecs_realloc(W, C_arr->Cs, C_arr->len, len,
+                                    W->Cs.bytesizes[C_id]);
+        TNECS_CHECK(Cs);
+        C_arr->Cs   = Cs;
+        C_arr->len  = len;
+    }
+    W->plan.stale = 1;
+    return (1);
+}
+
+int tnecs_grow_byA(tnecs_W *W, size_t tID) {
+    TNECS_TRACE_B(W, TNECS_TRACE_GROW_byA, tID, 0);
+    size_t olen = W->byA.arr[tID].len_Es;
+    size_t nlen = (olen > 0) ? tnecs_grow_len(W, olen, olen + 1) :
+                               W->config.len_byA;
+
+    size_t bytesize = sizeof(*W->byA.arr[tID].Es);
+    tnecs_E *Es     = tnecs_realloc(W, W->byA.arr[tID].Es, olen, nlen,
+                                    bytesize);
+    TNECS_CHECK(Es);
+    W->byA.arr[tID].Es      = Es;
+    W->byA.arr[tID].len_Es  = nlen;
+    W->plan.stale   = 1;
+    TNECS_TRACE_E(W, TNECS_TRACE_GROW_byA, tID, 0);
     return (1);
 }
 
@@ -1560,6 +3638,244 @@ int tnecs_In_data(tnecs_In *in, void *data) {
     return (1);
 }
 
+/* -- Tracing -- */
+#ifdef TNECS_TRACE
+void tnecs_trace(tnecs_W *W,  int kind, char ph,
+                 size_t  id, size_t arg) {
+    tnecs_Ev *ev    = &W->trace.evs[W->trace.num++ % W->trace.len];
+    ev->ts          = TNECS_NOW();
+    ev->id          = id;
+    ev->arg         = arg;
+    ev->kind        = kind;
+    ev->ph          = ph;
+}
+#endif /* TNECS_TRACE */
+
+int tnecs_trace_dump(const tnecs_W *W, FILE *f) {
+    /* Chrome trace event format, ts in [us] */
+    static const char *const names[TNECS_TRACE_NUM] = {
+        "step",         "pipeline",     "phase",
+        "system",       "register_A",   "grow_E",
+        "grow_A",       "grow_byA",     "grow_C",
+        "grow_S",       "grow_Pi",      "grow_Ph",
+        "grow_open"
+    };
+    static const char *const args[TNECS_TRACE_NUM] = {
+        "",     "Pi",   "Pi",
+        "A_id", "A",    "",
+        "",     "",     "C_O",
+        "",     "",     "",
+        ""
+    };
+
+    if ((W->trace.evs == NULL) || (f == NULL))
+        return (0);
+
+    size_t first = (W->trace.num > W->trace.len) ?
+                   (W->trace.num - W->trace.len) : 0;
+    const char *sep = "";
+    fprintf(f, "{\"traceEvents\":[");
+    for (size_t i = first; i < W->trace.num; i++) {
+        /* Partner overwritten or not yet written: dropped */
+        if (!tnecs_trace_paired(W, first, i))
+            continue;
+        const tnecs_Ev *ev = &W->trace.evs[i % W->trace.len];
+        fprintf(f, "%s\n{\"name\":\"%s %zu\",\"cat\":\"tnecs\",",
+                sep, names[ev->kind], ev->id);
+        sep = ",";
+        fprintf(f, "\"ph\":\"%c\",\"pid\":1,\"tid\":1,", ev->ph);
+        fprintf(f, "\"ts\":%llu.%03llu,", ev->ts / 1000, ev->ts % 1000);
+        fprintf(f, "\"args\":{\"%s\":%zu}}",
+                args[ev->kind][0] ? args[ev->kind] : "arg", ev->arg);
+    }
+    fprintf(f, "\n]}\n");
+    return (1);
+}
+
+int tnecs_trace_paired(const tnecs_W *W, size_t first, size_t i) {
+    /* Events nest: partner of i is first unmatched event
+    ** after B, or before E, within [first, num[ */
+    const tnecs_Ev *ev  = &W->trace.evs[i % W->trace.len];
+    int     fwd     = (ev->ph == 'B');
+    size_t  span    = fwd ? (W->trace.num - 1 - i) : (i - first);
+    size_t  depth   = 0;
+    for (size_t n = 1; n <= span; n++) {
+        size_t j = fwd ? (i + n) : (i - n);
+        const tnecs_Ev *other = &W->trace.evs[j % W->trace.len];
+        if (other->ph == ev->ph)
+            depth++;
+        else if (depth > 0)
+            depth--;
+        else
+            return ((other->kind == ev->kind) && (other->id == ev->id));
+    }
+    return (0);
+}
+
+void tnecs_trace_clear(tnecs_W *W) {
+    W->trace.num = 0;
+}
+
+/* -- Recording -- */
+void tnecs_write_u(FILE *f, unsigned long long u) {
+    /* LEB128: 7 bits per byte, high bit if more */
+    do {
+        int byte = u & 0x7F;
+        u >>= 7;
+        fputc(u ? (byte | 0x80) : byte, f);
+    } while (u);
+}
+
+#ifdef TNECS_RECORD
+void tnecs_record(tnecs_W *W, int op, size_t num,
+                  const unsigned long long *args) {
+    fputc(op,  W->record);
+    fputc((int)num, W->record);
+    for (size_t i = 0; i < num; i++)
+        tnecs_write_u(W->record, args[i]);
+}
+#endif /* TNECS_RECORD */
+
+int tnecs_record_start(tnecs_W *W, FILE *f) {
+#ifdef TNECS_RECORD
+    if (f == NULL)
+        return (0);
+    fwrite(TNECS_REC_MAGIC, 1, strlen(TNECS_REC_MAGIC), f);
+    tnecs_write_u(f, TNECS_REC_VERSION);
+    W->record = f;
+    return (1);
+#else
+    (void)W;
+    (void)f;
+    return (0);
+#endif /* TNECS_RECORD */
+}
+
+void tnecs_record_stop(tnecs_W *W) {
+    if (W->record != NULL)
+        fflush(W->record);
+    W->record = NULL;
+}
+
+/* -- Profiling -- */
+const tnecs_S_prof *tnecs_S_profile(const tnecs_W *W, size_t S_id) {
+    if ((W->Ss.prof == NULL) || (S_id >= W->Ss.num))
+        return (NULL);
+    return (&W->Ss.prof[S_id]);
+}
+
+void tnecs_profile_reset(tnecs_W *W) {
+    if (W->Ss.prof == NULL)
+        return;
+    memset(W->Ss.prof, 0, W->Ss.len * sizeof(*W->Ss.prof));
+}
+
+/* -- Memory accounting -- */
+int tnecs_A_stats(const tnecs_W *W, size_t A_id, tnecs_A_Stats *stats) {
+    if ((stats == NULL) || (A_id >= W->byA.num))
+        return (0);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->A        = W->byA.arr[A_id].A;
+    stats->num_Es   = W->byA.arr[A_id].num_Es;
+    stats->len_Es   = W->byA.arr[A_id].len_Es;
+    stats->num_Cs   = W->byA.arr[A_id].num_Cs;
+    stats->bytes_Es = stats->len_Es * sizeof(tnecs_E);
+    stats->slack    = (stats->len_Es - stats->num_Es) *
+                      sizeof(tnecs_E);
+
+    for (size_t C_O = 0; C_O < stats->num_Cs; C_O++) {
+        const tnecs_C_arr *C_arr = &W->byA.arr[A_id].Cs[C_O];
+        size_t C_by = W->Cs.bytesizes[W->byA.arr[A_id].Cs_id[C_O]];
+        stats->bytes_C[C_O]  = C_arr->len * C_by;
+        stats->bytes_Cs     += C_arr->len * C_by;
+        stats->slack        += (C_arr->len - C_arr->num) * C_by;
+    }
+
+    if (W->byA.arr[A_id].subA != NULL)
+        stats->meta += W->byA.arr[A_id].len_A_ids * sizeof(size_t);
+    stats->meta += stats->num_Cs * TNECS_ARCH_C_BYTES;
+    return (1);
+}
+
+int tnecs_W_stats(const tnecs_W *W, tnecs_Stats *stats) {
+    if (stats == NULL)
+        return (0);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->bytes_W      = sizeof(*W);
+    stats->bytes_Es     = W->Es.len * (sizeof(*W->Es.id) +
+                                       sizeof(*W->Es.Os) +
+                                       sizeof(*W->Es.As));
+    stats->bytes_open   = W->Es.open.len * sizeof(tnecs_E) +
+                          TNECS_BITS_LEN(W->Es.len) * sizeof(*W->Es.isOpen);
+    if (W->Es.gen != NULL)
+        stats->bytes_Es += W->Es.len * sizeof(*W->Es.gen);
+
+    /* Systems */
+    size_t S_by = sizeof(*W->Ss.Phs)   + sizeof(*W->Ss.Os)     +
+                  sizeof(*W->Ss.Ex)    + sizeof(*W->Ss.As)     +
+                  sizeof(*W->Ss.Pi)    + sizeof(*W->Ss.batch)  +
+                  sizeof(*W->Ss.plan_O) + sizeof(*W->Ss.plan_num);
+    if (W->Ss.prof != NULL)
+        S_by += sizeof(*W->Ss.prof);
+    stats->bytes_Ss     = W->Ss.len * S_by;
+#ifndef NDEBUG
+    stats->bytes_Ss    += (W->Ss.ran.len + W->Ss.to_run.len) *
+                          sizeof(tnecs_S_f);
+#endif /* NDEBUG */
+
+    /* Pipelines & phases */
+    stats->bytes_Phs    = W->Pis.len * sizeof(*W->Pis.byPh);
+    for (size_t Pi = 0; Pi < W->Pis.len; Pi++) {
+        const tnecs_Phs *byPh = &W->Pis.byPh[Pi];
+        stats->bytes_Phs += byPh->len * (sizeof(*byPh->len_Ss) +
+                                         sizeof(*byPh->num_Ss) +
+                                         sizeof(*byPh->Ss_id)  +
+                                         sizeof(*byPh->Ss));
+        for (size_t Ph = 0; Ph < byPh->len; Ph++) {
+            stats->bytes_Phs += byPh->len_Ss[Ph] *
+                                (sizeof(**byPh->Ss_id) +
+                                 sizeof(**byPh->Ss));
+        }
+    }
+
+    /* Plan & trace */
+    stats->bytes_plan   = W->plan.len * (sizeof(*W->plan.Ss)    +
+                                         sizeof(*W->plan.Ss_id) +
+                                         sizeof(*W->plan.tables));
+    stats->bytes_plan  += W->plan.Cs.len * sizeof(void *);
+    stats->bytes_trace  = W->trace.len * sizeof(*W->trace.evs);
+
+    /* Archetypes */
+    stats->bytes_As     = W->byA.len * sizeof(*W->byA.arr);
+    /* Unregistered slots: only Es & subA allocated */
+    for (size_t A_id = W->byA.num; A_id < W->byA.len; A_id++) {
+        if (W->byA.arr[A_id].Es != NULL)
+            stats->bytes_As += W->byA.arr[A_id].len_Es * sizeof(tnecs_E);
+        if (W->byA.arr[A_id].subA != NULL)
+            stats->bytes_As += W->byA.arr[A_id].len_A_ids *
+                               sizeof(size_t);
+    }
+
+    tnecs_A_Stats A_stats;
+    for (size_t A_id = 0; A_id < W->byA.num; A_id++) {
+        TNECS_CHECK(tnecs_A_stats(W, A_id, &A_stats));
+        stats->bytes_Cs += A_stats.bytes_Cs;
+        stats->slack    += A_stats.slack;
+        stats->meta     += A_stats.meta;
+        stats->bytes_As += A_stats.bytes_Es + A_stats.bytes_Cs +
+                           A_stats.meta;
+    }
+
+    stats->total    = stats->bytes_W     + stats->bytes_Es   +
+                      stats->bytes_open  + stats->bytes_Ss   +
+                      stats->bytes_Phs   + stats->bytes_plan +
+                      stats->bytes_trace + stats->bytes_As;
+    stats->counts   = W->counts;
+    return (1);
+}
+
 /*************** SET BIT COUNTING *******************/
 size_t setBits_KnR(tnecs_C flags) {
     /* Credits: Kernighan&Ritchie in 'C Programming Language' */
@@ -1579,8 +3895,12 @@ void *tnecs_C_array(tnecs_W *W, const size_t C_id,
     if (C_id >= W->Cs.num)
         return (NULL);
 
-    tnecs_C_arr *carr = W->byA.Cs[tID];
-    size_t       C_O  = W->byA.Cs_O[tID][C_id];
+    tnecs_C_arr *carr = W->byA.arr[tID].Cs;
+    size_t       C_O  = W->byA.arr[tID].Cs_O[C_id];
 
+    /* Writable: copy column shared with clones */
+    if ((carr == NULL) ||
+        !tnecs_C_own(W, &carr[C_O], W->Cs.bytesizes[C_id]))
+        return (NULL);
     return (carr[C_O].Cs);
 }
@@ -43,9 +43,23 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <stddef.h>
 #ifndef log2 /* for tcc: log2(x) = log(x) / log(2) */
     #define log2(x) (log(x) * 1.44269504088896340736)
 #endif
+/* Opt-in system profiling, tracing, recording */
+#if defined(TNECS_PROFILE) || defined(TNECS_TRACE)
+    #include <time.h>
+#endif /* TNECS_PROFILE || TNECS_TRACE */
+/* Id reservation: C11 atomics, else GCC builtins, else one thread */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && \
+    !defined(__STDC_NO_ATOMICS__)
+    #include <stdatomic.h>
+    #define TNECS_ATOMICS_C11
+    typedef atomic_size_t tnecs_atomic;
+#else
+    typedef size_t tnecs_atomic;
+#endif /* __STDC_VERSION__ */
 
 /* --- TYPEDEFS --- */
 typedef unsigned long long int tnecs_ns;
@@ -67,19 +81,99 @@ enum TNECS_PUBLIC {
     TNECS_C_CAP          =        64
 };
 
+enum TNECS_TRACE_KINDS {
+    TNECS_TRACE_STEP        =  0,
+    TNECS_TRACE_Pi          =  1,
+    TNECS_TRACE_Ph          =  2,
+    TNECS_TRACE_S           =  3,
+    TNECS_TRACE_REGISTER_A  =  4,
+    TNECS_TRACE_GROW_E      =  5,
+    TNECS_TRACE_GROW_A      =  6,
+    TNECS_TRACE_GROW_byA    =  7,
+    TNECS_TRACE_GROW_C      =  8,
+    TNECS_TRACE_GROW_S      =  9,
+    TNECS_TRACE_GROW_Pi     = 10,
+    TNECS_TRACE_GROW_Ph     = 11,
+    TNECS_TRACE_GROW_OPEN   = 12,
+    TNECS_TRACE_NUM         = 13
+};
+
 
 /* -- Functions -- */
 typedef void (*tnecs_S_f)   (struct tnecs_In *);
 typedef void (*tnecs_free_f)(void *);
 typedef void (*tnecs_init_f)(void *);
 
+/* Snapshot: raw bytes, same platform only */
+#define TNECS_SAVE_MAGIC    "tnecswld"
+#define TNECS_SAVE_VERSION  3
+#define TNECS_SAVE_HDR      12
+#define TNECS_SAVE_ALIGN    64
+
+/* Delta: ops byte, args are LEB128 varints */
+#define TNECS_DELTA_MAGIC   "tnecsdlt"
+#define TNECS_DELTA_VERSION 1
+enum TNECS_DELTA_OPS {
+    TNECS_DELTA_END     = 0,
+    TNECS_DELTA_DESTROY = 1, /* E                           */
+    TNECS_DELTA_CREATE  = 2, /* E, A                        */
+    TNECS_DELTA_A       = 3, /* E, A                        */
+    TNECS_DELTA_C       = 4, /* E, C_id, (same, run, XOR)s  */
+    TNECS_DELTA_OPEN    = 5, /* num, Es                     */
+};
+
+/* Recorded API calls, args are LEB128 varints:
+**  file:   TNECS_REC_MAGIC, version
+**  record: op byte, num args byte, args */
+#define TNECS_REC_MAGIC     "tnecsrec"
+#define TNECS_REC_VERSION   1
+enum TNECS_REC_OPS {
+    TNECS_REC_CREATE        =  1,   /* E                        */
+    TNECS_REC_DESTROY       =  2,   /* E                        */
+    TNECS_REC_ADD_C         =  3,   /* E, A, isNew              */
+    TNECS_REC_RM_C          =  4,   /* E, A                     */
+    TNECS_REC_STEP          =  5,   /* dt                       */
+    TNECS_REC_REGISTER_C    =  6,   /* bytesize                 */
+    TNECS_REC_REGISTER_S    =  7,   /* Pi, Ph, isEx, num_Cs, A  */
+    TNECS_REC_REGISTER_S_BATCH = 8, /* Pi, Ph, num_Cs, A        */
+    TNECS_REC_REGISTER_Pi   =  9,   /* Pi                       */
+    TNECS_REC_REGISTER_Ph   = 10,   /* Pi                       */
+    TNECS_REC_REUSE_E       = 11,   /* toggle                   */
+    TNECS_REC_GEN_E         = 12,   /* toggle                   */
+    TNECS_REC_NUM           = 13
+};
+
+/* Deferred structural changes */
+enum TNECS_CMD_OPS {
+    TNECS_CMD_CREATE        = 0,    /* A, Cs                    */
+    TNECS_CMD_DESTROY       = 1,    /* E                        */
+    TNECS_CMD_ADD_C         = 2,    /* E, A, Cs                 */
+    TNECS_CMD_RM_C          = 3,    /* E, A                     */
+};
+
 /* -- struct -- */
+typedef struct tnecs_S_prof {
+    /* Per system, if compiled with TNECS_PROFILE.
+    **  Run: all calls of system, in one step.
+    **  Steps without calls, i.e. no Es, are not runs */
+    size_t   runs;
+    size_t   calls;
+    size_t   num_As;    /* archetypes with Es run on */
+    size_t   num_Es;    /* entities processed   */
+    tnecs_ns total;     /* [ns] */
+    tnecs_ns min;       /* [ns] per run */
+    tnecs_ns max;       /* [ns] per run */
+    tnecs_ns run;       /* [ns] current run */
+    size_t   run_calls; /* calls in current run */
+} tnecs_S_prof;
+
 typedef struct tnecs_C_arr { /* 1D array of Cs */
     size_t   num;
     size_t   len;
 
     tnecs_C  type;
-    void    *Cs; /* [E_O_byA] */
+    void    *Cs;    /* [E_O_byA] */
+    size_t  *refs;  /* Owners, if shared by COW clones */
 } tnecs_C_arr;
 
 typedef struct tnecs_arr {
@@ -89,6 +183,23 @@ typedef struct tnecs_arr {
     void    *arr;
 } tnecs_arr;
 
+typedef struct tnecs_Ev {
+    tnecs_ns    ts;     /* [ns] */
+    size_t      id;     /* Pi, Ph, S_id, A_id... */
+    size_t      arg;
+    int         kind;
+    char        ph;     /* 'B'egin or 'E'nd */
+} tnecs_Ev;
+
+typedef struct tnecs_Trace {
+    /* Ring buffer, if compiled with TNECS_TRACE.
+    **  num: total events, oldest are overwritten */
+    size_t num;
+    size_t len;
+
+    tnecs_Ev *evs; /* [num % len] */
+} tnecs_Trace;
+
 typedef struct tnecs_Phs {
     /* phase == id == 1++ */
     size_t num;
@@ -118,6 +229,8 @@ typedef struct tnecs_Es {
     tnecs_E     *id; /* [E] */
     size_t      *Os; /* [E] */
     tnecs_C     *As; /* [E] */
+    size_t      *gen;       /* [E] if gen_Es, else NULL */
+    unsigned long long *isOpen; /* [E / 64] bit: E in open */
     tnecs_arr  open;
 } tnecs_Es;
 
@@ -125,34 +238,72 @@ typedef struct tnecs_Ss {
     size_t num;
     size_t len;
 
-    tnecs_Ph    *Phs;   /* [S_id] */
-    size_t      *Os;    /* [S_id] */
-    int         *Ex;    /* [S_id] */
-    tnecs_C     *As;    /* [S_id] */
-    tnecs_Pi    *Pi;    /* [S_id] */
+    tnecs_Ph    *Phs;       /* [S_id] */
+    size_t      *Os;        /* [S_id] */
+    int         *Ex;        /* [S_id] */
+    tnecs_C     *As;        /* [S_id] */
+    tnecs_Pi    *Pi;        /* [S_id] */
+    int         *batch;     /* [S_id] */
+    size_t      *plan_O;    /* [S_id] first pair in plan */
+    size_t      *plan_num;  /* [S_id] num pairs in plan  */
+    tnecs_S_prof *prof;     /* [S_id] if TNECS_PROFILE   */
     /* Systems maybe run in current pipeline */
     tnecs_arr to_run;
     /* Systems ran, if num_Es > 0 */
     tnecs_arr ran;
 } tnecs_Ss;
 
+typedef struct tnecs_Arch {
+    /* One archetype, one record.
+    **  First 64 bytes, adjacent: rows & columns read by steps.
+    **  Then: column order of C_id, read by get_C.
+    **  byA.arr not cache aligned: no line boundary implied. */
+    size_t        num_Es;
+    tnecs_E      *Es;       /* [E_O_byA]  */
+    tnecs_C_arr  *Cs;       /* [C_O_byA]  */
+    tnecs_C      *Cs_id;    /* [C_O_byA], in Cs block */
+    size_t        num_Cs;
+    tnecs_C       A;
+    size_t        len_Es;
+    size_t        num_A_ids;
+    unsigned char Cs_O[TNECS_C_CAP];  /* [C_id] */
+    size_t        len_A_ids;
+    size_t       *subA;     /* [subA_O]   */
+} tnecs_Arch;
+
 typedef struct tnecs_As {
     size_t num;
     size_t len;
 
-    tnecs_C      *A;            /* [A_id]   */
-    size_t       *num_Cs;       /* [A_id]   */
-    size_t       *len_Es;       /* [A_id]   */
-    size_t       *num_Es;       /* [A_id]   */
-    size_t       *num_A_ids;    /* [A_id]   */
-
-    size_t      **subA;     /* [A_id][subA_O]   */
-    tnecs_E     **Es;       /* [A_id][E_O_byA]  */
-    size_t      **Cs_O;     /* [A_id][C_id]     */
-    tnecs_C     **Cs_id;    /* [A_id][C_O_byA]  */
-    tnecs_C_arr **Cs;       /* [A_id][C_O_byA]  */
+    tnecs_Arch *arr;    /* [A_id] */
 } tnecs_As;
 
+typedef struct tnecs_Table {
+    /* Archetype rows, columns input into systems */
+    size_t    A_id;
+    size_t    num_Es;
+    tnecs_E  *Es;   /* [E_O_byA] */
+    /* Columns of system Cs, by increasing C_id:
+    **  C_O_byS: order of component in system archetype. */
+    void    **Cs;   /* [C_O_byS] */
+} tnecs_Table;
+
+typedef struct tnecs_Plan {
+    /* Flat execution plan: every (system, archetype) pair,
+    ** ordered by pipeline, phase, system order.
+    ** Only rebuilt after structural changes. */
+    size_t num;
+    size_t len;
+    int    dirty;   /* Pairs need rebuild               */
+    int    stale;   /* Column pointers need resolving   */
+
+    tnecs_S_f   *Ss;        /* [plan_O] */
+    size_t      *Ss_id;     /* [plan_O] */
+    tnecs_Table *tables;    /* [plan_O] */
+    /* Columns of all tables, contiguous */
+    tnecs_arr    Cs;
+} tnecs_Plan;
+
 typedef struct tnecs_Cs {
     size_t          num;
     size_t          bytesizes[TNECS_C_CAP]; /* [C_id] */
@@ -160,21 +311,149 @@ typedef struct tnecs_Cs {
     tnecs_free_f    ffree[TNECS_C_CAP];     /* [C_id] */
 } tnecs_Cs;
 
+typedef struct tnecs_Map {
+    /* Snapshot mapped by tnecs_W_map, if TNECS_MMAP */
+    void   *base;
+    size_t  len;
+} tnecs_Map;
+
+typedef struct tnecs_Alloc {
+    /* All world memory. bytes: as allocated, for free too.
+    ** realloc may be NULL: alloc, copy, free instead.  */
+    void *(*alloc)(void *ctx, size_t bytes); /* zeroed */
+    void *(*realloc)(void *ctx, void *ptr,
+                     size_t obytes, size_t nbytes);
+    void  (*free)(void *ctx, void *ptr, size_t bytes);
+    void   *ctx;
+} tnecs_Alloc;
+
+typedef struct tnecs_Config {
+    /* Initial lengths, 0: default */
+    size_t len_Es;  /* Entity table & open list, 128    */
+    size_t len_byA; /* Es of each archetype, 128        */
+    size_t len_C;   /* Columns of each archetype, 8     */
+    size_t len_As;  /* Archetypes, 16                   */
+    size_t len_Ss;  /* Systems & plan, 16               */
+    /* Growth: len * grow, or len + linear once len >= linear */
+    double grow;    /* > 1, 0: default 2                */
+    size_t linear;  /* 0: always geometric              */
+    /* tnecs_W_idle grows arrays filled above len * high */
+    double high;    /* (0, 1], 0: default 0.75          */
+} tnecs_Config;
+
+typedef struct tnecs_Counts {
+    /* Since genesis */
+    size_t migrations;      /* Es changing archetype        */
+    size_t reallocs;        /* Array growths                */
+    size_t bytes_copied;    /* By reallocs, migrations, dels */
+    size_t rejects;         /* Ops & allocs refused, locked  */
+} tnecs_Counts;
+
+typedef struct tnecs_Cmd {
+    int     op;     /* TNECS_CMD_* */
+    tnecs_E E;
+    tnecs_C A;
+    size_t  S_id;   /* Recording system, 0: none */
+    size_t  seq;    /* Recording order */
+    size_t  off;    /* Cs in Cmds bytes */
+    size_t  bytes;  /* 0: no Cs */
+} tnecs_Cmd;
+
+typedef struct tnecs_Cmds {
+    /* W's: recorded by tnecs_cmd_*, applied at end of phase.
+    ** Per thread: tnecs_cmds_push, merged into W's */
+    size_t num;
+    size_t len;
+    size_t num_bytes;
+    size_t len_bytes;
+    size_t S_id;    /* W's: running system */
+
+    tnecs_Cmd       *arr;
+    unsigned char   *bytes;
+    tnecs_Alloc      alloc;
+} tnecs_Cmds;
+
+typedef struct tnecs_Rsv {
+    /* Es reserved by any thread, from tnecs_W_ids to tnecs_E_sync:
+    **  open list popped down to open, then bumped up to next < cap */
+    tnecs_atomic open;
+    tnecs_atomic next;
+    size_t       cap;   /* 0: no reservation */
+} tnecs_Rsv;
+
 typedef struct tnecs_W {
     tnecs_Ss    Ss;
     tnecs_Es    Es;
     tnecs_As    byA;
     tnecs_Pis   Pis;
     tnecs_Cs    Cs;
+    tnecs_Plan  plan;
+    tnecs_Trace trace;
+    tnecs_Counts counts;
+    FILE       *record; /* if TNECS_RECORD */
+    tnecs_Map   map;
+    tnecs_Alloc alloc;
+    tnecs_Config config;
+    tnecs_Cmds  cmds;
+    tnecs_Rsv   rsv;
     int reuse_Es;
+    int gen_Es;         /* Handles: index & generation */
+    int locked;         /* No allocation, growth rejected */
 } tnecs_W;
 
+typedef struct tnecs_Ring {
+    /* Last len clones. num: total pushed */
+    size_t num;
+    size_t len;
+
+    tnecs_W **Ws; /* [num % len] */
+} tnecs_Ring;
+
+typedef struct tnecs_A_Stats {
+    /* Bytes of one archetype. Slack: allocated, unused. */
+    tnecs_C A;
+    size_t  num_Es;
+    size_t  len_Es;
+    size_t  num_Cs;
+    size_t  bytes_Es;   /* Es array                         */
+    size_t  bytes_Cs;   /* All columns                      */
+    size_t  slack;      /* Es array & columns               */
+    size_t  meta;       /* subA, Cs block: C_arrs & Cs_id  */
+    size_t  bytes_C[TNECS_C_CAP];   /* [C_O_byA] */
+} tnecs_A_Stats;
+
+typedef struct tnecs_Stats {
+    /* Bytes of whole world. total: sum of all below. */
+    size_t bytes_W;     /* sizeof(tnecs_W)                  */
+    size_t bytes_Es;    /* Entity table: id, Os, As         */
+    size_t bytes_open;  /* Open list                        */
+    size_t bytes_Ss;    /* System table                     */
+    size_t bytes_Phs;   /* Pipeline & phase tables          */
+    size_t bytes_plan;  /* Execution plan                   */
+    size_t bytes_trace; /* Trace buffer                     */
+    size_t bytes_As;    /* Archetype table & all archetypes */
+    size_t total;
+    /* Sums over all archetypes */
+    size_t bytes_Cs;
+    size_t slack;
+    size_t meta;
+    tnecs_Counts counts;
+} tnecs_Stats;
+
 typedef struct tnecs_In {
     tnecs_W *world;
     tnecs_ns dt;
+    size_t   S_id;
     tnecs_C  S_A;
     size_t   num_Es;
     size_t   E_A_id;
+    tnecs_E *Es;    /* [E_O_byA] */
+    void   **Cs;    /* [C_O_byS] */
+    /* Batch systems: all matched archetypes at once.
+    **  Other systems: one table, same as above.
+    **  Note: num_Es is the total of all tables. */
+    tnecs_Table *tables;        /* [table_O] */
+    size_t       num_tables;
     void    *data;
 } tnecs_In;
 
@@ -221,15 +500,80 @@ typedef struct tnecs_In {
 
 /* --- WORLD --- */
 int tnecs_genesis(tnecs_W **w);
+/* All world memory through alloc. NULL: calloc & free */
+int tnecs_genesis_alloc(tnecs_W **w, const tnecs_Alloc *alloc);
+/* Initial lengths & growth policy. NULL config: defaults */
+int tnecs_genesis_config(tnecs_W **w, const tnecs_Config *config,
+                         const tnecs_Alloc *alloc);
 int tnecs_finale(tnecs_W **w);
 
 /* Toggle entity reuse i.e. deleted entity in queue */
-void tnsecs_reuse_E( tnecs_W *w, int toggle);
+void tnecs_W_reuse_E(tnecs_W *w, int toggle);
+/* Toggle generational handles: destroying increments generation of
+** index, stale handles don't exist. Handles as indices: TNECS_E_IDX.
+** Off: fails if a live E has a nonzero generation */
+int tnecs_W_gen_E(tnecs_W *w, int toggle);
+
+/* Room for num more Es in archetype A, registered if new */
+int tnecs_W_reserve(tnecs_W *w, tnecs_C A, size_t num);
+/* Toggle locked world: never allocates. Ops that would grow
+** or register fail, counted in counts.rejects, W unchanged.
+** tnecs_W_apply always fails when locked */
+int tnecs_W_lock(tnecs_W *w, int toggle);
+/* Grow arrays near full ahead of creates, e.g. between frames.
+** Copies at most bytes, 0: no limit. Growths over budget skipped */
+int tnecs_W_idle(tnecs_W *w, size_t bytes);
 
 /* Run all systems, by pipelines and phases */
 int tnecs_step( tnecs_W *w,     tnecs_ns dt, 
                 void    *data);
 
+/* Snapshot of Cs, archetypes, Es & columns, in bulk.
+**  Load: genesis, then snapshot. Caller re-registers
+**  pipelines, phases, systems, sets Cs finit & ffree.
+**  Snapshot starts at current position of f: offsets are
+**  relative to it. f left after snapshot, for both. */
+int tnecs_W_save(const tnecs_W *w, FILE *f);
+int tnecs_W_load(tnecs_W **w, FILE *f);
+/* Loaded world memory through alloc, grows with config.
+**  NULL: defaults, like tnecs_genesis_config */
+int tnecs_W_load_config(tnecs_W **w, FILE *f,
+                        const tnecs_Config *config,
+                        const tnecs_Alloc  *alloc);
+#ifdef TNECS_MMAP
+/* POSIX: columns point into file, copy-on-write.
+**  Pages load on first touch, copied to heap on growth.
+**  Snapshot must start the file. */
+int tnecs_W_map(tnecs_W **w, const char *path);
+int tnecs_W_map_config(tnecs_W **w, const char *path,
+                       const tnecs_Config *config,
+                       const tnecs_Alloc  *alloc);
+#endif /* TNECS_MMAP */
+
+/* Delta of w from base: created, destroyed Es, archetype
+**  changes, changed rows XOR base rows. Skips unchanged
+**  archetypes. Apply to a world in base state. */
+int tnecs_W_diff(const tnecs_W *base, const tnecs_W *w, FILE *f);
+int tnecs_W_apply(tnecs_W *w, FILE *f);
+
+/* Clone: bulk copy of all arrays. Systems shared.
+**  COW: columns shared until either world writes them:
+**  get_C, structural changes, steps with systems on them. */
+int tnecs_W_clone(      tnecs_W *w, tnecs_W **out);
+int tnecs_W_clone_cow(  tnecs_W *w, tnecs_W **out);
+
+/* Ring of COW clones, for rewinding. back 0: last push. */
+int tnecs_ring_genesis(tnecs_Ring *ring, size_t len);
+int tnecs_ring_finale( tnecs_Ring *ring);
+int tnecs_ring_push(   tnecs_Ring *ring, tnecs_W *w);
+int tnecs_ring_rewind( tnecs_Ring *ring, size_t back, tnecs_W **w);
+tnecs_W *tnecs_ring_get(const tnecs_Ring *ring, size_t back);
+
+/* Memory accounting, see tnecs_Stats */
+int tnecs_W_stats(const tnecs_W *w, tnecs_Stats *stats);
+int tnecs_A_stats(const tnecs_W *w, size_t       A_id,
+                  tnecs_A_Stats *stats);
+
 /* --- PIPELINES --- */
 /* Run all systems in pipeline, by phases */
 int tnecs_step_Pi(  tnecs_W *w,     tnecs_ns dt,
@@ -254,6 +598,26 @@ int tnecs_custom_S_run( tnecs_W *w,     tnecs_S_f     s,
 /* -- tnecs_in -- */
 int tnecs_In_data(tnecs_In *in, void *data);
 
+/* -- Profiling -- */
+/* NULL unless compiled with TNECS_PROFILE */
+const tnecs_S_prof *tnecs_S_profile(const tnecs_W *w, size_t id);
+void tnecs_profile_reset(tnecs_W *w);
+
+/* -- Tracing -- */
+/* Chrome trace JSON of buffered events, 0 unless
+** compiled with TNECS_TRACE. Unpaired B/E events dropped */
+int  tnecs_trace_dump(const tnecs_W *w, FILE *f);
+void tnecs_trace_clear(tnecs_W *w);
+
+/* -- Recording -- */
+/* Appends public API calls to f, until stopped.
+**  Nested calls are recorded as their parts:
+**      - tnecs_E_create_wC:    create, add_C
+**      - tnecs_step:           step only
+**  0 unless compiled with TNECS_RECORD. */
+int  tnecs_record_start(tnecs_W *w, FILE *f);
+void tnecs_record_stop( tnecs_W *w);
+
 /* --- REGISTRATION --- */
 /* Phases start at 1, increment every call. */
 size_t tnecs_register_Ph(   tnecs_W *w, tnecs_Pi pi);
@@ -275,6 +639,22 @@ size_t tnecs_register_S(tnecs_W     *w,     tnecs_S_f    s,
         )\
     )
 
+/* Batch systems are inclusive, called once per step
+** with tables of all matched archetypes. */
+size_t tnecs_register_S_batch(  tnecs_W     *w,     tnecs_S_f    s,
+                                tnecs_Pi     pi,    tnecs_Ph    ph,
+                                size_t       num,   tnecs_C     arch);
+
+#define TNECS_REGISTER_S_BATCH(W, func, Pi, Ph, ...) \
+    tnecs_register_S_batch(\
+        W, func, Pi, Ph, \
+        TNECS_ARGN(__VA_ARGS__), \
+        tnecs_C_ids2A(\
+            TNECS_ARGN(__VA_ARGS__), \
+            TNECS_COMMA(__VA_ARGS__)\
+        )\
+    )
+
 /* Component ID start at 1, increment every call. */
 tnecs_C tnecs_register_C(   tnecs_W         *w,
                             size_t           b,
@@ -296,20 +676,60 @@ tnecs_E tnecs_E_rm_C(   tnecs_W *w, tnecs_E E,
                         tnecs_C  A);
 
 int tnecs_E_open_find(  tnecs_W *w);
+
+/* --- ID RESERVATION --- */
+/* Reserve: any thread, lock-free with atomics, between tnecs_W_ids
+**  & tnecs_E_sync. No other entity changes in between.
+**  Ids: from open list first, then after Es.num.
+**  Block: contiguous ids after Es.num, outputs first.
+**  Sync: reserved Es created, in null archetype. */
+int     tnecs_W_ids(        tnecs_W *w, size_t num);
+tnecs_E tnecs_E_reserve(    tnecs_W *w);
+tnecs_E tnecs_E_reserve_n(  tnecs_W *w, size_t num);
+int     tnecs_E_sync(       tnecs_W *w);
+
+/* --- COMMANDS --- */
+/* Structural changes from systems, deferred to end of phase.
+**  Cs: all Cs of A by increasing C_id, replace initialized Cs.
+**      NULL: initialized only.
+**  Apply: non-creates, then creates by archetype.
+**      By recording system, then in order.
+**      Failure: applied commands dropped, failed one and
+**      rest stay in buffer for next apply. */
+int tnecs_cmd_create(   tnecs_W *w, tnecs_C A, const void *Cs);
+int tnecs_cmd_destroy(  tnecs_W *w, tnecs_E E);
+int tnecs_cmd_add_C(    tnecs_W *w, tnecs_E E,
+                        tnecs_C  A, const void *Cs);
+int tnecs_cmd_rm_C(     tnecs_W *w, tnecs_E E, tnecs_C A);
+int tnecs_cmds_apply(   tnecs_W *w);
+
+/* Per-thread buffers, with own allocator e.g. an arena.
+**  Push: reads W only, no lock. Stamped with input's system.
+**  Merge: at sync, into W's buffer, resets bufs.
+**  Applied by system then order: parallel runs match serial. */
+int tnecs_cmds_genesis( tnecs_Cmds *cmds, const tnecs_Alloc *alloc);
+int tnecs_cmds_finale(  tnecs_Cmds *cmds);
+int tnecs_cmds_push(    tnecs_Cmds      *cmds,  const tnecs_In *input,
+                        int              op,    tnecs_E         E,
+                        tnecs_C          A,     const void     *Cs);
+int tnecs_cmds_merge(   tnecs_W *w, tnecs_Cmds *bufs, size_t num);
 int tnecs_E_open_flush( tnecs_W *w);
 
 #define TNECS_E_CREATE_wC(W, ...) \
     tnecs_E_create_wC(  W, TNECS_ARGN(__VA_ARGS__), \
                         TNECS_COMMA(__VA_ARGS__))
+/* Handle: generation in high bits if gen_Es, else the index */
+#define TNECS_E_IDX(w, E) ((w)->gen_Es ? ((E) & 0xFFFFFFFFULL) : (E))
+#define TNECS_E_GEN(E) ((E) >> 32)
 #define TNECS_E_EXISTS(w, i) \
-    ((i != TNECS_NULL) && (w->Es.id[i] == i))
-#define TNECS_E_A(w, e) w->Es.As[e]
+    ((i != TNECS_NULL) && (w->Es.id[TNECS_E_IDX(w, i)] == i))
+#define TNECS_E_A(w, e) w->Es.As[TNECS_E_IDX(w, e)]
 
 /* --- COMPONENT --- */
 void *tnecs_get_C(tnecs_W *w, tnecs_E E, tnecs_C C_id);
 
 #define TNECS_E_HAS_C(w, e, C_id) \
-        ((w->Es.As[e] & tnecs_C_ids2A(1, C_id)) > 0)
+        ((TNECS_E_A(w, e) & tnecs_C_ids2A(1, C_id)) > 0)
 #define TNECS_ADD_C(...) \
     TNECS_CHOOSE_ADD_C(\
         __VA_ARGS__, TNECS_ADD_C4, TNECS_ADD_C3 \
@@ -338,11 +758,14 @@ void *tnecs_get_C(tnecs_W *w, tnecs_E E, tnecs_C C_id);
     )
 
 /* --- COMPONENT ARRAY --- */
+/* Writable: column shared with COW clones is copied first */
 void *tnecs_C_array(tnecs_W     *w, const size_t     C_id,
                     const size_t tID);
 
 #define TNECS_C_ARRAY(in, C_id) \
     tnecs_C_array(in->world, C_id, in->E_A_id)
+/* Pre-resolved column, C_O_byS: order in system archetype */
+#define TNECS_In_C(in, C_O_byS) ((in)->Cs[(C_O_byS)])
 
 /* --- ARCHETYPES --- */
 tnecs_C tnecs_C_ids2A(size_t argnum, ...);
@@ -7,6 +7,7 @@ perf record -F 99 -g ./test
 perf script | gprof2dot -f perf | dot -Tpng -o output.png
 
 # --- cache misses ---
+# Per operation counters: ./bench -perf
 # Check with accessible fields:
 sudo perf list cache
 # Disable nim watchdog:  echo 0 > /proc/sys/kernel/nmi_watchdog